@@ -0,0 +1,171 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "batchrunner.h"
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+
+BatchRunner::BatchRunner(QString location, QObject *parent)
+        : QObject(parent), folder(location), force(false), out(stdout), finished(0)
+{
+    taskQueue = new TaskQueue(this);
+    jobServer = new JobServer(this);
+    jobServer->setTokens(taskQueue->getMaxJobs());
+    taskQueue->setJobServer(jobServer);
+    workerPool = new WorkerPool(this);
+    connect(workerPool, &WorkerPool::changed, [=]() { taskQueue->setRemoteSlots(workerPool->getSlots()); });
+    connect(taskQueue, &TaskQueue::launch, this, &BatchRunner::launchTask);
+    scanner = new ProjectScanner(this);
+    connect(scanner, &ProjectScanner::finished, this, &BatchRunner::filesFound);
+}
+
+void BatchRunner::setMaxJobs(int jobs)
+{
+    taskQueue->setMaxJobs(jobs);
+    jobServer->setTokens(jobs);
+}
+
+void BatchRunner::start()
+{
+    timer.start();
+    scanner->scan(folder);
+}
+
+void BatchRunner::filesFound(QStringList found)
+{
+    for (auto name : found) {
+        std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(QFileInfo(folder.filePath(name)));
+        f->setRelativeName(name);
+        f->parse();
+        f->update();
+        if (f->haveTasks()) {
+            for (const auto &task : f->getTasks()) {
+                names << f->getRelativeName() + "#" + task->getTaskName();
+                items[names.last()] = task.get();
+            }
+        } else {
+            names << f->getRelativeName();
+            items[names.last()] = f.get();
+        }
+        files.push_back(std::move(f));
+    }
+    out << "Found " << names.size() << " tasks in " << files.size() << " files" << endl;
+
+    QStringList queue;
+    for (auto name : names) {
+        if (!force && items[name]->isUpToDate()) {
+            out << "[" << name << "] " << items[name]->getStatus() << " (up to date)" << endl;
+            finished++;
+            continue;
+        }
+        queue << name;
+    }
+    // cached results finish right away, so only wait for idle once everything is queued
+    for (auto name : queue)
+        taskQueue->enqueue(name);
+    if (taskQueue->isIdle())
+        finish();
+    else
+        connect(taskQueue, &TaskQueue::idle, this, &BatchRunner::finish);
+}
+
+void BatchRunner::launchTask(QString name)
+{
+    if (taskQueue->isRemote(name) && workerPool->getFreeSlots() == 0) {
+        taskQueue->remoteUnavailable(name);
+        return;
+    }
+    out << "[" << name << "] started" << endl;
+    TaskRunner *runner = new TaskRunner(items[name]);
+    runners[name].reset(runner);
+    connect(runner, &TaskRunner::output, [=](QString data) { printOutput(name, data); });
+    connect(runner, &TaskRunner::finished, [=](int) { taskFinished(name); });
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    jobServer->addToEnvironment(env);
+    runner->start(env, taskQueue->isRemote(name) ? workerPool : nullptr);
+}
+
+void BatchRunner::printOutput(QString name, QString data)
+{
+    // tasks run in parallel, so only print whole lines with the task in front
+    QStringList lines = (partialLines.take(name) + data).split('\n');
+    partialLines[name] = lines.takeLast();
+    for (auto line : lines)
+        out << "[" << name << "] " << line << "\n";
+    out.flush();
+}
+
+void BatchRunner::taskFinished(QString name)
+{
+    if (!partialLines.value(name).isEmpty())
+        printOutput(name, "\n");
+    partialLines.remove(name);
+    SBYItem *item = items[name];
+    finished++;
+    out << "[" << name << "] " << (item->getStatus().isEmpty() ? QString("ERROR") : item->getStatus());
+    if (item->getTimeSpent() != -1)
+        out << " in " << item->getTimeSpent() << " sec";
+    out << " (" << finished << "/" << names.size() << ")" << endl;
+    // the runner is still inside its finished signal
+    runners[name].release()->deleteLater();
+    runners.erase(name);
+    taskQueue->finished(name);
+}
+
+void BatchRunner::finish()
+{
+    int failed = 0;
+    for (auto name : names)
+        if (items[name]->getStatus() != "PASS")
+            failed++;
+    out << names.size() - failed << " passed, " << failed << " failed in " << timer.elapsed() / 1000 << " sec" << endl;
+    if (!junitFile.isEmpty() && !writeJUnit()) {
+        out << "Unable to write " << junitFile << endl;
+        Q_EMIT done(2);
+        return;
+    }
+    Q_EMIT done(failed ? 1 : 0);
+}
+
+bool BatchRunner::writeJUnit()
+{
+    QDomDocument junit;
+    junit.appendChild(junit.createProcessingInstruction("xml", "version=\"1.0\" encoding=\"UTF-8\""));
+    QDomElement root = junit.createElement("testsuites");
+    junit.appendChild(root);
+    for (auto name : names) {
+        SBYItem *item = items[name];
+        if (!QFileInfo(item->getResultFile()).exists())
+            item->writeStatusXML("ERROR", "sby did not produce a result", 0);
+        QDomDocument xml;
+        QFile f(item->getResultFile());
+        if (!f.open(QIODevice::ReadOnly) || !xml.setContent(&f))
+            continue;
+        QDomNodeList testsuites = xml.elementsByTagName("testsuite");
+        for (int i = 0; i < testsuites.size(); i++)
+            root.appendChild(junit.importNode(testsuites.at(i), true));
+    }
+    QFile f(junitFile);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    f.write(junit.toByteArray(2));
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <map>
+#include <memory>
+#include <vector>
+#include "jobserver.h"
+#include "projectscanner.h"
+#include "sbyitem.h"
+#include "taskqueue.h"
+#include "taskrunner.h"
+#include "workerpool.h"
+
+// Headless run of a whole folder for CI: finds the .sby files the same way
+// the GUI does, runs their tasks through the task queue and writes all
+// results into a single JUnit file.
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit BatchRunner(QString location, QObject *parent = 0);
+
+    void setMaxJobs(int jobs);
+    void setJUnitFile(QString fileName) { junitFile = fileName; }
+    void setForce(bool enabled) { force = enabled; }
+    bool addWorker(QString address) { return workerPool->addWorker(address); }
+    void setFilters(QStringList include, QStringList exclude) { scanner->setFilters(include, exclude); }
+    void start();
+
+  Q_SIGNALS:
+    void done(int exitCode);
+
+  protected:
+    void filesFound(QStringList found);
+    void launchTask(QString name);
+    void taskFinished(QString name);
+    void printOutput(QString name, QString data);
+    void finish();
+    bool writeJUnit();
+
+    QDir folder;
+    QString junitFile;
+    bool force;
+    std::vector<std::unique_ptr<SBYFile>> files;
+    QStringList names;
+    QMap<QString, SBYItem *> items;
+    std::map<QString, std::unique_ptr<TaskRunner>> runners;
+    QMap<QString, QString> partialLines;
+    TaskQueue *taskQueue;
+    JobServer *jobServer;
+    WorkerPool *workerPool;
+    ProjectScanner *scanner;
+    QElapsedTimer timer;
+    QTextStream out;
+    int finished;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,163 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "controlserver.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+
+ControlServer::ControlServer(QObject *parent) : QObject(parent)
+{
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &ControlServer::newConnection);
+
+    methods["subscribe"] = [=](const QJsonObject &, QString &) { return QJsonValue(true); };
+    methods["unsubscribe"] = methods["subscribe"];
+}
+
+bool ControlServer::listen(QString path)
+{
+    // only take over a socket left behind by an instance that did not exit
+    // cleanly, never the one of a GUI that is still running
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    if (probe.waitForConnected(500)) {
+        probe.abort();
+        listenError = "another instance is listening on " + path;
+        return false;
+    }
+    listenError.clear();
+    QLocalServer::removeServer(path);
+    return server->listen(path);
+}
+
+void ControlServer::newConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        subscriptions[socket];
+        connect(socket, &QLocalSocket::readyRead, [=]() { readRequests(socket); });
+        connect(socket, &QLocalSocket::disconnected, [=]() {
+            subscriptions.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::readRequests(QLocalSocket *socket)
+{
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        QJsonDocument reply;
+        if (parseError.error != QJsonParseError::NoError) {
+            reply = QJsonDocument(error(QJsonValue::Null, -32700, parseError.errorString()));
+        } else if (doc.isArray()) {
+            QJsonArray replies;
+            for (auto request : doc.array()) {
+                QJsonObject response = handleRequest(socket, request);
+                if (!response.isEmpty())
+                    replies << response;
+            }
+            if (!replies.isEmpty())
+                reply = QJsonDocument(replies);
+        } else {
+            QJsonObject response = handleRequest(socket, doc.object());
+            if (!response.isEmpty())
+                reply = QJsonDocument(response);
+        }
+        if (!reply.isNull())
+            socket->write(reply.toJson(QJsonDocument::Compact) + "\n");
+    }
+}
+
+QJsonObject ControlServer::error(const QJsonValue &id, int code, QString message)
+{
+    QJsonObject err;
+    err["code"] = code;
+    err["message"] = message;
+    QJsonObject response;
+    response["jsonrpc"] = "2.0";
+    response["error"] = err;
+    response["id"] = id;
+    return response;
+}
+
+QJsonObject ControlServer::handleRequest(QLocalSocket *socket, const QJsonValue &value)
+{
+    QJsonObject request = value.toObject();
+    QJsonValue id = request.contains("id") ? request["id"] : QJsonValue(QJsonValue::Undefined);
+    QString name = request["method"].toString();
+    if (!value.isObject() || request["jsonrpc"].toString() != "2.0" || name.isEmpty())
+        return error(id.isUndefined() ? QJsonValue(QJsonValue::Null) : id, -32600, "Invalid request");
+    if (!methods.contains(name))
+        return id.isUndefined() ? QJsonObject() : error(id, -32601, "Method not found");
+
+    QJsonObject params = request["params"].toObject();
+    if (name == "subscribe" || name == "unsubscribe") {
+        for (auto event : params["events"].toArray()) {
+            if (name == "subscribe")
+                subscriptions[socket].insert(event.toString());
+            else
+                subscriptions[socket].remove(event.toString());
+        }
+    }
+    QString message;
+    QJsonValue result = methods[name](params, message);
+    // notifications never get an answer, not even an error
+    if (id.isUndefined())
+        return QJsonObject();
+    if (!message.isEmpty())
+        return error(id, -32602, message);
+    QJsonObject response;
+    response["jsonrpc"] = "2.0";
+    response["result"] = result;
+    response["id"] = id;
+    return response;
+}
+
+void ControlServer::notify(QString event, const QJsonObject &params)
+{
+    // a client that stopped reading would otherwise collect every log line
+    static const qint64 maxPending = 4 << 20;
+    QByteArray message;
+    QList<QLocalSocket *> stalled;
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+        if (!it.value().contains(event))
+            continue;
+        if (message.isEmpty()) {
+            QJsonObject notification;
+            notification["jsonrpc"] = "2.0";
+            notification["method"] = event;
+            notification["params"] = params;
+            message = QJsonDocument(notification).toJson(QJsonDocument::Compact) + "\n";
+        }
+        if (it.key()->bytesToWrite() > maxPending)
+            stalled << it.key();
+        else
+            it.key()->write(message);
+    }
+    for (auto socket : stalled) {
+        subscriptions.remove(socket);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
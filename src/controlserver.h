@@ -0,0 +1,63 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <functional>
+
+// JSON-RPC 2.0 on a local socket, one message per line. Methods are
+// provided by the owner, events are pushed to the clients that called
+// subscribe with their name.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    typedef std::function<QJsonValue(const QJsonObject &params, QString &error)> Method;
+
+    explicit ControlServer(QObject *parent = 0);
+
+    bool listen(QString path);
+    bool isListening() { return server->isListening(); }
+    QString errorString() { return listenError.isEmpty() ? server->errorString() : listenError; }
+    QString serverPath() { return server->fullServerName(); }
+    void addMethod(QString name, Method method) { methods[name] = method; }
+    void notify(QString event, const QJsonObject &params);
+
+  protected:
+    void newConnection();
+    void readRequests(QLocalSocket *socket);
+    QJsonObject handleRequest(QLocalSocket *socket, const QJsonValue &request);
+    QJsonObject error(const QJsonValue &id, int code, QString message);
+
+    QLocalServer *server;
+    QString listenError;
+    QMap<QString, Method> methods;
+    QMap<QLocalSocket *, QSet<QString>> subscriptions;
+};
+
+#endif // CONTROLSERVER_H
@@ -0,0 +1,185 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "detachedrun.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTextCodec>
+#include "procinfo.h"
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#endif
+
+// the exit code is moved into place, a half written one is never read
+static const char *wrapperScript = "sby \"$@\" >\"$SBYGUI_LOG\" 2>&1; "
+                                   "echo $? >\"$SBYGUI_LOG.exit.tmp\"; "
+                                   "mv \"$SBYGUI_LOG.exit.tmp\" \"$SBYGUI_LOG.exit\"";
+
+DetachedRun::DetachedRun(QString logFile, QObject *parent) : QObject(parent), logFile(logFile), pid(0), offset(0)
+{
+    // output is cut into slices anywhere, multi byte characters included
+    decoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+    timer = new QTimer(this);
+    timer->setInterval(250);
+    connect(timer, &QTimer::timeout, this, &DetachedRun::poll);
+}
+
+DetachedRun::~DetachedRun() { delete decoder; }
+
+bool DetachedRun::isSupported()
+{
+#ifdef Q_OS_UNIX
+    static const bool supported =
+            !QStandardPaths::findExecutable("setsid").isEmpty() && QFileInfo::exists("/proc/self/environ");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool DetachedRun::isRunning(qint64 pid, QString logFile)
+{
+#ifdef Q_OS_UNIX
+    if (pid <= 0 || ::kill(pid, 0) != 0)
+        return false;
+    // the wrapper shell carries the log file in its environment
+    QFile env(QString("/proc/%1/environ").arg(pid));
+    if (!env.open(QIODevice::ReadOnly))
+        return !QFileInfo::exists("/proc/self");
+    return env.readAll().split('\0').contains("SBYGUI_LOG=" + logFile.toLocal8Bit());
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(logFile);
+    return false;
+#endif
+}
+
+// the pid may belong to someone else by now, only what still carries the
+// log file in its environment is ours, and nothing once the exit file is there
+void DetachedRun::signalRun(qint64 pid, QString logFile, QList<int> signalList)
+{
+#ifdef Q_OS_UNIX
+    if (pid <= 0 || QFileInfo::exists(logFile + ".exit"))
+        return;
+    ProcessInfo::signalSession(pid, signalList, isRunning(pid, logFile), "SBYGUI_LOG=" + logFile.toLocal8Bit());
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(logFile);
+    Q_UNUSED(signalList);
+#endif
+}
+
+bool DetachedRun::start(QStringList args, QString workDir, QProcessEnvironment env)
+{
+    QFile::remove(exitFile());
+    QFile log(logFile);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    log.close();
+
+    QStringList arguments;
+    arguments << "-c" << wrapperScript << "sh" << args;
+    QProcess process;
+    // own session like SBYProcess, the wrapper's pid is its id; startDetached
+    // alone calls setsid() in an intermediate child that exits right away
+    QString setsid = QStandardPaths::findExecutable("setsid");
+    if (setsid.isEmpty())
+        return false;
+    process.setProgram(setsid);
+    arguments.prepend("/bin/sh");
+    env.insert("SBYGUI_LOG", logFile);
+    process.setArguments(arguments);
+    process.setProcessEnvironment(env);
+    process.setWorkingDirectory(workDir);
+    if (!process.startDetached(&pid))
+        return false;
+    offset = 0;
+    timer->start();
+    return true;
+}
+
+bool DetachedRun::attach(qint64 runPid, qint64 logOffset)
+{
+    pid = runPid;
+    offset = logOffset;
+    if (!isRunning(pid, logFile) && !QFileInfo::exists(exitFile()))
+        return false;
+    timer->start();
+    return true;
+}
+
+void DetachedRun::poll()
+{
+    // decided before reading, whatever sby wrote is in the log by then
+    bool alive = !QFileInfo::exists(exitFile()) && isRunning(pid, logFile);
+    QFile log(logFile);
+    if (log.open(QIODevice::ReadOnly) && log.size() > offset && log.seek(offset)) {
+        // in slices, a run that wrote a lot while nobody watched must not block the GUI
+        QByteArray data = log.read(1 << 20);
+        offset += data.size();
+        if (!data.isEmpty())
+            Q_EMIT output(decoder->toUnicode(data));
+        if (offset < log.size())
+            return;
+    }
+    if (alive)
+        return;
+
+    timer->stop();
+    int exitCode = -1;
+    QFile code(exitFile());
+    if (code.open(QIODevice::ReadOnly)) {
+        bool ok;
+        int value = code.readAll().trimmed().toInt(&ok);
+        if (ok)
+            exitCode = value;
+        code.close();
+        code.remove();
+    } else {
+#ifdef Q_OS_UNIX
+        // the wrapper died without sby returning, take down what it left behind
+        signalRun(pid, logFile, {SIGKILL});
+#endif
+    }
+    Q_EMIT finished(exitCode);
+}
+
+void DetachedRun::terminateTree(int killTimeout)
+{
+#ifdef Q_OS_UNIX
+    qint64 sid = pid;
+    QString log = logFile;
+    if (sid <= 0)
+        return;
+    signalRun(sid, log, {SIGTERM});
+    // not bound to this object, it is usually deleted as soon as sby exits
+    QTimer::singleShot(killTimeout, [sid, log]() { signalRun(sid, log, {SIGKILL}); });
+#else
+    Q_UNUSED(killTimeout);
+#endif
+}
+
+void DetachedRun::killTree()
+{
+#ifdef Q_OS_UNIX
+    signalRun(pid, logFile, {SIGSTOP, SIGKILL});
+#endif
+}
@@ -0,0 +1,81 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef DETACHEDRUN_H
+#define DETACHEDRUN_H
+
+#include <QObject>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QTextDecoder>
+#include <QTimer>
+
+// What it takes to pick a detached run up again
+struct DetachedState
+{
+    qint64 pid = 0;
+    qint64 offset = 0;
+    qint64 startedAt = 0;
+    QString fingerprint;
+};
+
+// sby started in a session of its own that outlives the GUI. The output
+// goes to a log file that is followed from a byte offset, and the exit
+// code is written next to it once sby is done, so a later GUI instance
+// can attach to a run it did not start.
+class DetachedRun : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit DetachedRun(QString logFile, QObject *parent = 0);
+    virtual ~DetachedRun();
+
+    // needs setsid(1) for a session led by the wrapper and /proc to tell
+    // its processes apart, elsewhere runs stay attached to the GUI
+    static bool isSupported();
+    // still running and not just a process that got the same pid later on
+    static bool isRunning(qint64 pid, QString logFile);
+
+    bool start(QStringList args, QString workDir, QProcessEnvironment env);
+    // false if the run is gone without leaving an exit code behind
+    bool attach(qint64 runPid, qint64 logOffset);
+    void terminateTree(int killTimeout = 500);
+    void killTree();
+
+    qint64 processId() { return pid; }
+    qint64 getOffset() { return offset; }
+
+  Q_SIGNALS:
+    void output(QString data);
+    void finished(int exitCode);
+
+  protected:
+    void poll();
+    QString exitFile() { return logFile + ".exit"; }
+    static void signalRun(qint64 pid, QString logFile, QList<int> signalList);
+
+    QString logFile;
+    qint64 pid;
+    qint64 offset;
+    QTimer *timer;
+    QTextDecoder *decoder;
+};
+
+#endif // DETACHEDRUN_H
@@ -0,0 +1,82 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "fileloader.h"
+#include <QRunnable>
+#include "workspacecache.h"
+
+class ParseJob : public QRunnable
+{
+  public:
+    ParseJob(FileLoader *loader, QFileInfo path, QJsonObject cached, int generation)
+            : loader(loader), path(path), cached(cached), generation(generation)
+    {
+    }
+
+    void run() override
+    {
+        SBYFile *file = new SBYFile(path);
+        if (!WorkspaceCache::restoreParsed(file, cached, true))
+            file->parse();
+        file->update();
+        Q_EMIT loader->parsed(generation, file);
+    }
+
+  protected:
+    FileLoader *loader;
+    QFileInfo path;
+    QJsonObject cached;
+    int generation;
+};
+
+FileLoader::FileLoader(QObject *parent) : QObject(parent), generation(0), pending(0)
+{
+    qRegisterMetaType<SBYFile *>();
+    pool = new QThreadPool(this);
+    connect(this, &FileLoader::parsed, this, [=](int jobGeneration, SBYFile *file) {
+        // result of a load that was cancelled in the meantime
+        if (jobGeneration != generation) {
+            delete file;
+            return;
+        }
+        pending--;
+        Q_EMIT loaded(file);
+        if (pending == 0)
+            Q_EMIT finished();
+    }, Qt::QueuedConnection);
+}
+
+FileLoader::~FileLoader()
+{
+    cancel();
+    pool->waitForDone();
+}
+
+void FileLoader::load(QFileInfo path, QJsonObject cached)
+{
+    pending++;
+    pool->start(new ParseJob(this, path, cached, generation));
+}
+
+void FileLoader::cancel()
+{
+    pool->clear();
+    generation++;
+    pending = 0;
+}
@@ -0,0 +1,59 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QObject>
+#include <QThreadPool>
+#include "sbyitem.h"
+
+Q_DECLARE_METATYPE(SBYFile *)
+
+// Parses .sby files on a thread pool, one sby process per task makes this
+// the slowest part of opening a workspace. Files are handed back on the
+// GUI thread as soon as each one is done. A workspace cache entry whose
+// contents hash still matches is used instead of parsing.
+class FileLoader : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit FileLoader(QObject *parent = 0);
+    virtual ~FileLoader();
+
+    void load(QFileInfo path, QJsonObject cached = QJsonObject());
+    void cancel();
+    bool isLoading() { return pending > 0; }
+
+  Q_SIGNALS:
+    // the receiver owns the file
+    void loaded(SBYFile *file);
+    void finished();
+    void parsed(int generation, SBYFile *file);
+
+  protected:
+    QThreadPool *pool;
+    int generation;
+    int pending;
+};
+
+#endif // FILELOADER_H
@@ -0,0 +1,109 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "fingerprint.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QStandardPaths>
+
+struct FileHashEntry
+{
+    qint64 size;
+    QDateTime modified;
+    QByteArray hash;
+};
+
+static QString runVersion(QString program, QStringList args)
+{
+    QString version;
+    QString executable = QStandardPaths::findExecutable(program);
+    if (executable.isEmpty())
+        return program + " not found\n";
+    QFileInfo info(executable);
+    version += info.canonicalFilePath() + " " + QString::number(info.size()) + " " +
+               info.lastModified().toString(Qt::ISODate) + "\n";
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(executable, args);
+    if (process.waitForFinished(5000))
+        version += process.readAllStandardOutput();
+    return version;
+}
+
+QString Fingerprint::toolVersions()
+{
+    // asked once, thread safe initialization of a local static does the locking
+    static const QString versions =
+            runVersion("sby", QStringList() << "--version") + runVersion("yosys", QStringList() << "-V");
+    return versions;
+}
+
+QByteArray Fingerprint::fileHash(QString path)
+{
+    // rehash only when size or modification time changed; files are parsed
+    // and checked on several threads at once, only the cache is shared
+    static QHash<QString, FileHashEntry> cache;
+    static QMutex mutex;
+    QFileInfo info(path);
+    if (!info.exists() || !info.isFile())
+        return QByteArray("missing");
+    {
+        QMutexLocker locker(&mutex);
+        auto it = cache.find(path);
+        if (it != cache.end() && it->size == info.size() && it->modified == info.lastModified())
+            return it->hash;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray("unreadable");
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    FileHashEntry entry{info.size(), info.lastModified(), hash.result().toHex()};
+    QMutexLocker locker(&mutex);
+    cache.insert(path, entry);
+    return entry.hash;
+}
+
+QString Fingerprint::sourcePath(QString entry, QDir base)
+{
+    // [files] lines are either "source" or "destination source"
+    QStringList parts = entry.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    if (parts.isEmpty())
+        return QString();
+    return QFileInfo(base, parts.last()).absoluteFilePath();
+}
+
+QString Fingerprint::compute(QString config, QStringList files, QDir base)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData("sby-gui fingerprint 1\n");
+    hash.addData(toolVersions().toUtf8());
+    hash.addData(config.toUtf8());
+    for (auto entry : files) {
+        hash.addData(entry.toUtf8() + "\n");
+        hash.addData(fileHash(sourcePath(entry, base)) + "\n");
+    }
+    return hash.result().toHex();
+}
@@ -0,0 +1,39 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+
+// Hash of everything a task result depends on: the expanded config,
+// the contents of all [files] entries and the sby/yosys versions.
+class Fingerprint
+{
+  public:
+    static QString compute(QString config, QStringList files, QDir base);
+    static QString sourcePath(QString entry, QDir base);
+    static QByteArray fileHash(QString path);
+    static QString toolVersions();
+    static QString fileName() { return "sbygui.fingerprint"; }
+};
+
+#endif // FINGERPRINT_H
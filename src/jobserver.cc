@@ -0,0 +1,174 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "jobserver.h"
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+JobServer::JobServer(QObject *parent)
+        : QObject(parent), valid(false), generation(0), tokens(1), debt(0), readFd(-1), writeFd(-1),
+          childReadFd(-1), childWriteFd(-1), notifier(nullptr)
+{
+    tokens = std::max(QThread::idealThreadCount(), 1);
+    valid = openFifo();
+    if (valid)
+        writeTokens(tokens - 1);
+}
+
+JobServer::~JobServer() { closeFifo(); }
+
+bool JobServer::openFifo()
+{
+#ifdef Q_OS_UNIX
+    if (!dir.isValid())
+        return false;
+    QByteArray fifo = QFile::encodeName(dir.filePath(QString("jobserver%1").arg(generation++)));
+    if (mkfifo(fifo.constData(), 0600) != 0)
+        return false;
+    readFd = ::open(fifo.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    writeFd = ::open(fifo.constData(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    // separate open file description, so O_NONBLOCK of the GUI side is not shared
+    childReadFd = ::open(fifo.constData(), O_RDONLY | O_NONBLOCK);
+    childWriteFd = ::open(fifo.constData(), O_WRONLY);
+    // children only know the descriptors
+    ::unlink(fifo.constData());
+    if (readFd < 0 || writeFd < 0 || childReadFd < 0 || childWriteFd < 0)
+        return false;
+    fcntl(childReadFd, F_SETFL, fcntl(childReadFd, F_GETFL) & ~O_NONBLOCK);
+
+    notifier = new QSocketNotifier(readFd, QSocketNotifier::Read, this);
+    notifier->setEnabled(false);
+    connect(notifier, &QSocketNotifier::activated, [=]() {
+        notifier->setEnabled(false);
+        Q_EMIT tokenAvailable();
+    });
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JobServer::closeFifo()
+{
+    delete notifier;
+    notifier = nullptr;
+#ifdef Q_OS_UNIX
+    for (int *fd : {&readFd, &writeFd, &childReadFd, &childWriteFd}) {
+        if (*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+#endif
+}
+
+void JobServer::writeTokens(int count)
+{
+#ifdef Q_OS_UNIX
+    for (int i = 0; i < count; i++) {
+        char token = '+';
+        if (::write(writeFd, &token, 1) != 1)
+            break;
+    }
+#endif
+}
+
+void JobServer::setTokens(int count)
+{
+    count = std::max(count, 1);
+    int diff = count - tokens;
+    tokens = count;
+    if (!valid)
+        return;
+    if (diff > 0) {
+        int paid = std::min(diff, debt);
+        debt -= paid;
+        writeTokens(diff - paid);
+    }
+    for (int i = 0; i < -diff; i++) {
+        if (!acquire())
+            debt++;
+    }
+}
+
+int JobServer::getFreeTokens()
+{
+    int available = 0;
+#ifdef Q_OS_UNIX
+    if (valid)
+        ioctl(readFd, FIONREAD, &available);
+#endif
+    return available;
+}
+
+bool JobServer::acquire()
+{
+    if (!valid)
+        return true;
+#ifdef Q_OS_UNIX
+    char token;
+    return ::read(readFd, &token, 1) == 1;
+#else
+    return true;
+#endif
+}
+
+void JobServer::release()
+{
+    if (!valid)
+        return;
+    if (debt > 0) {
+        debt--;
+        return;
+    }
+    writeTokens(1);
+}
+
+void JobServer::reset()
+{
+    if (!valid)
+        return;
+    // children of stopped runs may still hold tokens and hand them back
+    // once they exit, they do so into the old FIFO nobody reads any more
+    closeFifo();
+    debt = 0;
+    valid = openFifo();
+    if (valid)
+        writeTokens(tokens - 1);
+}
+
+void JobServer::waitForToken()
+{
+    if (notifier)
+        notifier->setEnabled(true);
+}
+
+void JobServer::addToEnvironment(QProcessEnvironment &env)
+{
+    if (!valid)
+        return;
+    QString fds = QString("%1,%2").arg(childReadFd).arg(childWriteFd);
+    env.insert("MAKEFLAGS", QString(" -j%1 --jobserver-fds=%2 --jobserver-auth=%2").arg(tokens).arg(fds));
+}
@@ -0,0 +1,72 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <QObject>
+#include <QProcessEnvironment>
+#include <QSocketNotifier>
+#include <QTemporaryDir>
+
+// GNU make compatible jobserver. Token pool lives in a FIFO, children get
+// their own blocking descriptors through MAKEFLAGS while the GUI itself
+// uses a private non-blocking one, so it never stalls waiting for a token.
+class JobServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit JobServer(QObject *parent = 0);
+    virtual ~JobServer();
+
+    bool isValid() { return valid; }
+    void setTokens(int count);
+    int getTokens() { return tokens; }
+    int getFreeTokens();
+    int getUsedTokens() { return tokens - getFreeTokens(); }
+
+    bool acquire();
+    void release();
+    // full pool in a new FIFO, whatever still runs keeps the old one
+    void reset();
+    void waitForToken();
+    void addToEnvironment(QProcessEnvironment &env);
+
+  Q_SIGNALS:
+    void tokenAvailable();
+
+  protected:
+    bool openFifo();
+    void closeFifo();
+    void writeTokens(int count);
+
+    bool valid;
+    int generation;
+    int tokens;
+    int debt;
+    int readFd;
+    int writeFd;
+    int childReadFd;
+    int childWriteFd;
+    QTemporaryDir dir;
+    QSocketNotifier *notifier;
+};
+
+#endif // JOBSERVER_H
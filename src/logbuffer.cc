@@ -0,0 +1,71 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "logbuffer.h"
+
+// most task logs stay far below the limit, so nothing is allocated up front
+LogBuffer::LogBuffer(int limit) : limit(qMax(1, limit)), head(0) {}
+
+void LogBuffer::setLimit(int limit)
+{
+    this->limit = qMax(1, limit);
+    int keep = qMin(ring.size(), this->limit);
+    QVector<QString> lines;
+    lines.reserve(keep);
+    for (int i = 0; i < keep; i++)
+        lines << ring[(head + ring.size() - keep + i) % ring.size()];
+    ring = lines;
+    head = 0;
+}
+
+void LogBuffer::addLine(const QString &line)
+{
+    // the ring only wraps once it is full, until then head stays at 0
+    if (ring.size() < limit) {
+        ring << line;
+    } else {
+        ring[head] = line;
+        head = (head + 1) % ring.size();
+    }
+}
+
+QStringList LogBuffer::append(const QString &data)
+{
+    QStringList lines;
+    int start = 0;
+    int end;
+    while ((end = data.indexOf('\n', start)) != -1) {
+        QString line = partial + data.midRef(start, end - start);
+        partial.clear();
+        addLine(line);
+        lines << line;
+        start = end + 1;
+    }
+    partial += data.midRef(start);
+    return lines;
+}
+
+QString LogBuffer::text() const
+{
+    QString text;
+    for (int i = 0; i < ring.size(); i++)
+        text += ring[(head + i) % ring.size()] + "\n";
+    return text + partial;
+}
@@ -0,0 +1,50 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// The last lines of one log in a ring that grows up to the limit, after
+// that the oldest line is dropped for every new one. Output arrives in chunks, a
+// line that is not finished yet is kept apart until it is.
+class LogBuffer
+{
+  public:
+    explicit LogBuffer(int limit = 10000);
+
+    void setLimit(int limit);
+    // returns the lines the data completed
+    QStringList append(const QString &data);
+    void addLine(const QString &line);
+    QString text() const;
+    bool isEmpty() const { return ring.isEmpty() && partial.isEmpty(); }
+
+  protected:
+    QVector<QString> ring;
+    int limit;
+    int head;
+    QString partial;
+};
+
+#endif // LOGBUFFER_H
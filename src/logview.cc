@@ -0,0 +1,142 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "logview.h"
+#include <QScrollBar>
+#include <QTextCursor>
+#include <QVBoxLayout>
+
+LogView::LogView(QFont font, QWidget *parent)
+        : QWidget(parent), pendingLines(0), rebuild(false), lineLimit(10000)
+{
+    channelBox = new QComboBox();
+    channelBox->addItem("All tasks");
+    channelBox->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    connect(channelBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+            &LogView::showChannel);
+
+    edit = new QPlainTextEdit();
+    edit->setReadOnly(true);
+    edit->setFont(font);
+    edit->setMaximumBlockCount(lineLimit + 1);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(2);
+    layout->addWidget(channelBox, 0, Qt::AlignLeft);
+    layout->addWidget(edit);
+
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(250);
+    connect(flushTimer, &QTimer::timeout, this, &LogView::flush);
+}
+
+void LogView::setLineLimit(int lines)
+{
+    lineLimit = qMax(1, lines);
+    combined.setLimit(lineLimit);
+    for (auto &buffer : channels)
+        buffer.setLimit(lineLimit);
+    edit->setMaximumBlockCount(lineLimit + 1);
+}
+
+void LogView::append(QString channel, QString data)
+{
+    QStringList lines;
+    if (channel.isEmpty()) {
+        lines = data.split('\n');
+        if (lines.last().isEmpty())
+            lines.removeLast();
+    } else {
+        if (!channels.contains(channel)) {
+            channels.insert(channel, LogBuffer(lineLimit));
+            channelBox->addItem(channel);
+        }
+        lines = channels[channel].append(data);
+        for (auto &line : lines)
+            line = "[" + channel + "] " + line;
+        if (channel == current)
+            queue(data, data.count('\n'));
+    }
+    for (auto line : lines)
+        combined.addLine(line);
+    if (current.isEmpty() && !lines.isEmpty())
+        queue(lines.join('\n') + "\n", lines.size());
+}
+
+void LogView::removeChannel(QString channel)
+{
+    if (!channels.remove(channel))
+        return;
+    // back to all tasks when it was the one on screen
+    if (channel == current)
+        channelBox->setCurrentIndex(0);
+    channelBox->removeItem(channelBox->findText(channel));
+}
+
+void LogView::clearChannels()
+{
+    channels.clear();
+    channelBox->setCurrentIndex(0);
+    while (channelBox->count() > 1)
+        channelBox->removeItem(1);
+}
+
+void LogView::queue(const QString &text, int lines)
+{
+    // more than fits is shown from the buffer instead
+    pendingLines += lines;
+    if (pendingLines > lineLimit) {
+        pending.clear();
+        rebuild = true;
+    } else if (!rebuild) {
+        pending += text;
+    }
+    if (!flushTimer->isActive())
+        flushTimer->start();
+}
+
+void LogView::showChannel(int index)
+{
+    current = index > 0 ? channelBox->itemText(index) : QString();
+    rebuild = true;
+    flush();
+}
+
+void LogView::flush()
+{
+    QScrollBar *bar = edit->verticalScrollBar();
+    bool atEnd = bar->value() == bar->maximum();
+    if (rebuild) {
+        edit->setPlainText(current.isEmpty() ? combined.text() : channels[current].text());
+        atEnd = true;
+    } else if (!pending.isEmpty()) {
+        QTextCursor cursor(edit->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(pending);
+    }
+    pending.clear();
+    pendingLines = 0;
+    rebuild = false;
+    // keep following the output unless scrolled back
+    if (atEnd)
+        bar->setValue(bar->maximum());
+}
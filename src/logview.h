@@ -0,0 +1,66 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QComboBox>
+#include <QMap>
+#include <QPlainTextEdit>
+#include <QTimer>
+#include <QWidget>
+#include "logbuffer.h"
+
+// Output of all tasks, combined or for a single one. Every task has a
+// bounded log of its own, the combined one gets whole lines tagged with
+// the task name so parallel runs do not interleave mid-line. Output is
+// collected and shown a few times per second at most.
+class LogView : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    explicit LogView(QFont font, QWidget *parent = 0);
+
+    void setLineLimit(int lines);
+    // an empty channel is for messages that belong to no task
+    void append(QString channel, QString data);
+    // the task is gone, its lines stay in the combined log
+    void removeChannel(QString channel);
+    void clearChannels();
+
+  protected:
+    void showChannel(int index);
+    void queue(const QString &text, int lines);
+    void flush();
+
+    QComboBox *channelBox;
+    QPlainTextEdit *edit;
+    QTimer *flushTimer;
+    LogBuffer combined;
+    QMap<QString, LogBuffer> channels;
+    QString current;
+    QString pending;
+    int pendingLines;
+    bool rebuild;
+    int lineLimit;
+};
+
+#endif // LOGVIEW_H
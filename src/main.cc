@@ -20,15 +20,204 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <QTimer>
+#include "batchrunner.h"
+#include "sbyconfig.h"
 #include "mainwindow.h"
+#include "resultcache.h"
+#include "workerprotocol.h"
+#include "workerserver.h"
+
+static bool hasOption(int argc, char *argv[], QString name)
+{
+    for (int i = 1; i < argc; i++) {
+        QString arg = argv[i];
+        if (arg == name || arg.startsWith(name + "="))
+            return true;
+    }
+    return false;
+}
+
+// worker daemon, never creates any widget so it runs on machines without a display
+static int runWorker(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SBY Gui");
+    QCoreApplication::setApplicationVersion("1.0");
+    QCommandLineParser parser;
+    QCommandLineOption workerOption("worker",
+                                    "Run tasks sent by other sby-gui instances, listening on [host:]port. Without a host only "
+                                    "on 127.0.0.1: whoever can connect runs arbitrary commands through sby configs. Other "
+                                    "addresses need a shared secret in SBYGUI_WORKER_SECRET, set the same for the clients.",
+                                    "address");
+    parser.addOption(workerOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of tasks to run in parallel", "N");
+    parser.addOption(jobsOption);
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.process(app);
+    int jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOption)) {
+        bool ok;
+        jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            printf("Invalid number of jobs specified.\n");
+            return -1;
+        }
+    }
+    WorkerServer server(std::max(jobs, 1), WorkerProtocol::secret());
+    if (!server.listen(parser.value(workerOption))) {
+        printf("Unable to listen on %s: %s\n", parser.value(workerOption).toLocal8Bit().constData(),
+               server.errorString().toLocal8Bit().constData());
+        return -1;
+    }
+    printf("Worker listening on %s with %d slots\n", parser.value(workerOption).toLocal8Bit().constData(), std::max(jobs, 1));
+    fflush(stdout);
+    return app.exec();
+}
+
+// runs every task of a folder and exits, for CI machines without a display
+static int runBatch(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SBY Gui");
+    QCoreApplication::setApplicationVersion("1.0");
+    QCommandLineParser parser;
+    parser.addPositionalArgument("source", "Source folder/directory to run");
+    QCommandLineOption batchOption("batch", "Run all tasks without opening a window, exit with 1 if any task did not pass");
+    parser.addOption(batchOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of tasks to run in parallel", "N");
+    parser.addOption(jobsOption);
+    QCommandLineOption junitOption("junit", "Write the results of all tasks into one JUnit XML file", "file");
+    parser.addOption(junitOption);
+    QCommandLineOption forceOption("force", "Also run tasks whose results are up to date");
+    parser.addOption(forceOption);
+    QCommandLineOption cacheSizeOption("cache-size", "Size limit of the result cache, 0 disables it (default 1024)", "MB");
+    parser.addOption(cacheSizeOption);
+    QCommandLineOption workersOption("workers", "Also run tasks on these sby-gui --worker daemons, authenticated with SBYGUI_WORKER_SECRET", "host:port,...");
+    parser.addOption(workersOption);
+    QCommandLineOption includeOption("include", "Only use .sby files matching this wildcard, can be given more than once", "glob");
+    parser.addOption(includeOption);
+    QCommandLineOption excludeOption("exclude", "Skip files and directories matching this wildcard, can be given more than once", "glob");
+    parser.addOption(excludeOption);
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.process(app);
+    const QStringList positionalArguments = parser.positionalArguments();
+    if (positionalArguments.size() > 1) {
+        printf("Several source folders/directories have been specified.\n");
+        return -1;
+    }
+    QFileInfo location(positionalArguments.size() ? positionalArguments[0] : QDir::currentPath());
+    if (!location.isDir()) {
+        printf("File location is not directory.\n");
+        return -1;
+    }
+    BatchRunner runner(location.absoluteFilePath());
+    if (parser.isSet(jobsOption)) {
+        bool ok;
+        int jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            printf("Invalid number of jobs specified.\n");
+            return -1;
+        }
+        runner.setMaxJobs(jobs);
+    }
+    if (parser.isSet(cacheSizeOption)) {
+        bool ok;
+        qint64 cacheSize = parser.value(cacheSizeOption).toLongLong(&ok);
+        if (!ok || cacheSize < 0) {
+            printf("Invalid cache size specified.\n");
+            return -1;
+        }
+        ResultCache::instance().setLimit(cacheSize << 20);
+    }
+    for (auto address : parser.value(workersOption).split(',', QString::SkipEmptyParts)) {
+        if (!runner.addWorker(address.trimmed())) {
+            printf("Invalid worker address %s.\n", address.toLocal8Bit().constData());
+            return -1;
+        }
+    }
+    runner.setJUnitFile(parser.value(junitOption));
+    runner.setForce(parser.isSet(forceOption));
+    runner.setFilters(parser.values(includeOption), parser.values(excludeOption));
+    QObject::connect(&runner, &BatchRunner::done, [&](int exitCode) { app.exit(exitCode); });
+    QTimer::singleShot(0, [&]() { runner.start(); });
+    int exitCode = app.exec();
+    ResultCache::instance().waitForDone();
+    return exitCode;
+}
+
+// compares the built-in .sby reader with sby itself for the given files and folders
+static int runCheckParser(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SBY Gui");
+    QCoreApplication::setApplicationVersion("1.0");
+    QCommandLineParser parser;
+    parser.addPositionalArgument("sources", "Files and folders with .sby files to check", "[sources...]");
+    QCommandLineOption checkOption("check-parser", "Compare the built-in .sby reader with sby --dumptasks and --dumpcfg");
+    parser.addOption(checkOption);
+    parser.addHelpOption();
+    parser.process(app);
+    QFileInfoList files;
+    for (auto source : parser.positionalArguments()) {
+        QFileInfo info(source);
+        if (info.isDir())
+            files << QDir(source).entryInfoList(QStringList() << "*.sby", QDir::Files);
+        else
+            files << info;
+    }
+    QTextStream out(stdout);
+    int failed = 0;
+    for (auto file : files)
+        if (!SBYConfig::compareWithSby(file, out))
+            failed++;
+    out << files.size() << " files checked, " << failed << " differ" << endl;
+    return failed ? 1 : 0;
+}
 
 int main(int argc, char *argv[])
 {
+    if (hasOption(argc, argv, "--check-parser"))
+        return runCheckParser(argc, argv);
+    if (hasOption(argc, argv, "--worker"))
+        return runWorker(argc, argv);
+    if (hasOption(argc, argv, "--batch"))
+        return runBatch(argc, argv);
+
     QApplication app(argc, argv);
     QCoreApplication::setApplicationName("SBY Gui");
     QCoreApplication::setApplicationVersion("1.0");
     QCommandLineParser parser;
     parser.addPositionalArgument("source", "Source folder/directory to open");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of tasks to run in parallel", "N");
+    parser.addOption(jobsOption);
+    QCommandLineOption memReserveOption("mem-reserve", "Do not start new tasks while less than MB of memory is available", "MB");
+    parser.addOption(memReserveOption);
+    QCommandLineOption memLimitOption("task-mem-limit", "Kill tasks whose processes use more than MB of memory", "MB");
+    parser.addOption(memLimitOption);
+    QCommandLineOption cacheSizeOption("cache-size", "Size limit of the result cache, 0 disables it (default 1024)", "MB");
+    parser.addOption(cacheSizeOption);
+    QCommandLineOption failFastOption("fail-fast", "Cancel remaining tasks of the same file or the whole workspace after a failure", "file|workspace");
+    parser.addOption(failFastOption);
+    QCommandLineOption watchOption("watch", "Rerun tasks automatically when their source files change");
+    parser.addOption(watchOption);
+    QCommandLineOption workersOption("workers", "Also run tasks on these sby-gui --worker daemons, authenticated with SBYGUI_WORKER_SECRET", "host:port,...");
+    parser.addOption(workersOption);
+    QCommandLineOption controlOption("control", "Accept JSON-RPC requests on this local socket", "path");
+    parser.addOption(controlOption);
+    QCommandLineOption logLinesOption("log-lines", "Number of lines kept of each task log and the combined log (default 10000)", "N");
+    parser.addOption(logLinesOption);
+    QCommandLineOption includeOption("include", "Only show .sby files matching this wildcard, can be given more than once", "glob");
+    parser.addOption(includeOption);
+    QCommandLineOption excludeOption("exclude", "Skip files and directories matching this wildcard, can be given more than once", "glob");
+    parser.addOption(excludeOption);
+    // handled before the application is created, only listed for --help
+    parser.addOption(QCommandLineOption("batch", "Run all tasks without opening a window, see --batch --help"));
+    parser.addOption(QCommandLineOption("worker", "Run as worker daemon, see --worker=port --help", "address"));
     parser.addHelpOption();
     parser.addVersionOption();
     parser.process(app);
@@ -46,8 +235,85 @@ int main(int argc, char *argv[])
             }
         }
     }
+    int jobs = 0;
+    if (parser.isSet(jobsOption)) {
+        bool ok;
+        jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            printf("Invalid number of jobs specified.\n");
+            return -1;
+        }
+    }
+    qint64 memReserve = 0;
+    qint64 memLimit = 0;
+    bool memOk = true;
+    if (parser.isSet(memReserveOption)) {
+        bool ok;
+        memReserve = parser.value(memReserveOption).toLongLong(&ok);
+        memOk &= ok;
+    }
+    if (parser.isSet(memLimitOption)) {
+        bool ok;
+        memLimit = parser.value(memLimitOption).toLongLong(&ok);
+        memOk &= ok;
+    }
+    if (!memOk || memReserve < 0 || memLimit < 0) {
+        printf("Invalid memory size specified.\n");
+        return -1;
+    }
+    if (parser.isSet(cacheSizeOption)) {
+        bool ok;
+        qint64 cacheSize = parser.value(cacheSizeOption).toLongLong(&ok);
+        if (!ok || cacheSize < 0) {
+            printf("Invalid cache size specified.\n");
+            return -1;
+        }
+        ResultCache::instance().setLimit(cacheSize << 20);
+    }
+    int logLines = 0;
+    if (parser.isSet(logLinesOption)) {
+        bool ok;
+        logLines = parser.value(logLinesOption).toInt(&ok);
+        if (!ok || logLines < 1) {
+            printf("Invalid number of log lines specified.\n");
+            return -1;
+        }
+    }
+    MainWindow::FailFast failFast = MainWindow::FailFastOff;
+    if (parser.isSet(failFastOption)) {
+        if (parser.value(failFastOption) == "file")
+            failFast = MainWindow::FailFastFile;
+        else if (parser.value(failFastOption) == "workspace")
+            failFast = MainWindow::FailFastWorkspace;
+        else {
+            printf("Invalid fail fast scope specified.\n");
+            return -1;
+        }
+    }
     MainWindow win(positionalArguments.size() ? positionalArguments[0] : QDir::currentPath());
+    if (jobs)
+        win.setMaxJobs(jobs);
+    win.setMemoryReserve(memReserve);
+    win.setTaskMemoryLimit(memLimit);
+    win.setFailFast(failFast);
+    if (logLines)
+        win.setLogLineLimit(logLines);
+    win.setWatchMode(parser.isSet(watchOption));
+    if (parser.isSet(includeOption) || parser.isSet(excludeOption))
+        win.setDiscoveryFilters(parser.values(includeOption), parser.values(excludeOption));
+    for (auto address : parser.value(workersOption).split(',', QString::SkipEmptyParts)) {
+        if (!win.addWorker(address.trimmed())) {
+            printf("Invalid worker address %s.\n", address.toLocal8Bit().constData());
+            return -1;
+        }
+    }
+    if (parser.isSet(controlOption) && !win.setControlSocket(parser.value(controlOption))) {
+        printf("Unable to listen on control socket %s.\n", parser.value(controlOption).toLocal8Bit().constData());
+        return -1;
+    }
     win.show();
 
-    return app.exec();
+    int exitCode = app.exec();
+    ResultCache::instance().waitForDone();
+    return exitCode;
 }
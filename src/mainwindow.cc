@@ -19,11 +19,11 @@
 
 #include "mainwindow.h"
 #include <QAction>
+#include <QDateTime>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QIcon>
 #include <QRadioButton>
-#include <QScrollArea>
 #include <QSplitter>
 #include <QTabBar>
 #include <QProgressBar>
@@ -33,7 +33,12 @@
 #include <QFile>
 #include <QGraphicsColorizeEffect>
 #include <QMessageBox>
+#include <algorithm>
 #include "lexers/LexSBY.h"
+#include "procinfo.h"
+#include "resultcache.h"
+#include "fingerprint.h"
+#include <QJsonArray>
 #include "../src/Catalogue.h"
 #include "ScintillaEdit.h"
 #include "SciLexer.h"
@@ -42,82 +47,229 @@
 
 static void initBasenameResource() { Q_INIT_RESOURCE(base); }
 
-void MainWindow::removeLayoutItems(QLayout* layout)
-{
-    while(layout->count()!=0)
-    {
-        QLayoutItem* child = layout->takeAt(0);
-        if(child->layout() != 0)
-        {
-            removeLayoutItems(child->layout());
-        }
-        else if(child->widget() != 0)
-        {
-            delete child->widget();
-        }
-
-        delete child;
-    }
-}
-
-QStringList MainWindow::getFileList(QDir path)
-{
-    QDir folder(path);
-    folder.setNameFilters(QStringList()<<"*.sby");
-    return folder.entryList();
-}
-
 void MainWindow::openLocation(QFileInfo path)
 {
-    QFileInfoList fileList;
+    // the runs of the folder shown so far are stopped below, nothing to pick up later
+    if (refreshLocation.isDir() && !resumePending)
+        RunJournal().save(currentFolder);
     refreshLocation = path;
     if(path.exists()) {
         if (path.isDir()) {
             currentFolder = path.absoluteFilePath();
-            currentFolder.setNameFilters(QStringList()<<"*.sby");
-            fileList = currentFolder.entryInfoList();
-            currentFileList = currentFolder.entryList();
         } else {
             QMessageBox::critical(this, "SBY Gui",
                                 "Invalid file location",
                                 QMessageBox::Ok);
             return;
         }
-        fileWatcher->addPath(currentFolder.canonicalPath());
-        for(auto name : fileList) {
-            fileWatcher->addPath(name.absoluteFilePath());
-        }        
     } 
 
+    watchQueue->clear();
+    watchedDirectories.clear();
+    fileLoader->cancel();
+    statusRefresher->cancel();
+    startWhenStale.clear();
+    changedWhileRunning.clear();
+    loadingFiles.clear();
+    taskModel->beginReload();
     items.clear();
-    removeLayoutItems(grid);
+    logView->clearChannels();
     fileMap.clear();
     files.clear();
-    taskList.clear();
+    taskModel->endReload();
+    taskQueue->clear();
+    currentFileList.clear();
+    workspaceCache.load(currentFolder);
+    resumePending = path.isDir();
+
+    if (path.isDir()) {
+        statusBar->showMessage("Scanning " + currentFolder.absolutePath() + "...");
+        scanner->scan(currentFolder);
+    } else {
+        loadingFinished();
+    }
+}
 
-    // create new widgets
-    int cnt = 0;
-    for (auto file : fileList)
-    {
-        std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(file);
-        f->parse();
-        f->update();
-        files.push_back(std::move(f));
-        fileMap.insert(file.absoluteFilePath(), files.back().get());
+void MainWindow::setDiscoveryFilters(QStringList include, QStringList exclude)
+{
+    scanner->setFilters(include, exclude);
+    if (refreshLocation.isDir())
+        scanner->scan(currentFolder);
+}
+
+// keep the folder order, files come back in whatever order they finish
+void MainWindow::insertFile(std::unique_ptr<SBYFile> f)
+{
+    auto pos = std::find_if(files.begin(), files.end(), [&](const std::unique_ptr<SBYFile> &other) {
+        return QString::compare(other->getRelativeName(), f->getRelativeName(), Qt::CaseInsensitive) > 0;
+    });
+    pos = files.insert(pos, std::move(f));
+    fileMap.insert((*pos)->getFullPath(), pos->get());
+    addFileItems(pos->get());
+    taskModel->addFile(pos->get());
+    QModelIndex index = taskModel->indexOf(pos->get());
+    taskView->expand(index.parent());
+    if (pos->get()->haveTasks())
+        taskView->expand(index);
+}
+
+void MainWindow::fileLoaded(SBYFile *file)
+{
+    std::unique_ptr<SBYFile> f(file);
+    f->setRelativeName(currentFolder.relativeFilePath(f->getFullPath()));
+    if (fileMap.contains(f->getFullPath()) && !loadingFiles.contains(f->getFullPath())) {
+        // shown from the workspace cache or parsed again after a change, take
+        // over the fresh status if the tasks are the same
+        SBYFile *current = fileMap[f->getFullPath()];
+        if (!current->sameConfig(*f)) {
+            applyParsed(current, *f);
+            return;
+        }
+        current->setParsedKey(f->getParsedSize(), f->getParsedModified(), f->getParsedHash());
+        current->takeStatus(*f);
+        QSBYItem *fileItem = items[current->getRelativeName()].get();
+        for (auto &it : items)
+            if (it.second.get() == fileItem || it.second->getParent() == fileItem)
+                it.second->refreshView();
+        cacheSaveTimer->start();
+        return;
     }
+    if (!loadingFiles.remove(f->getFullPath()) || fileMap.contains(f->getFullPath()))
+        return;
+    insertFile(std::move(f));
+    if (!loadingFiles.isEmpty())
+        statusBar->showMessage(QString("Loading %1 files...").arg(loadingFiles.size()));
+}
+
+void MainWindow::loadingFinished()
+{
+    rebuildSourceIndex();
+    cacheSaveTimer->start();
+    if (resumePending)
+        resumeRuns();
+    statusBar->showMessage(QString("Loaded %1 files").arg(files.size()), 5000);
+}
 
-    for(const auto & file : files) {
-        
-        grid->addWidget(generateFileBox(file.get()), cnt++, 0);
+void MainWindow::rebuildSourceIndex()
+{
+    // source file -> tasks using it, every source is watched so edits mark tasks stale
+    QMap<QString, QStringList> index;
+    for (auto &file : files) {
+        QDir base(file->getWorkFolder());
+        if (file->haveTasks()) {
+            for (const auto &task : file->getTasks())
+                for (auto entry : task->getFiles())
+                    index[Fingerprint::sourcePath(entry, base)] << file->getRelativeName() + "#" + task->getTaskName();
+        } else {
+            for (auto entry : file->getFiles())
+                index[Fingerprint::sourcePath(entry, base)] << file->getRelativeName();
+        }
     }
-    grid->setRowStretch(cnt++,1);
+    for (auto path : sourceIndex.keys())
+        if (!index.contains(path) && !fileMap.contains(path))
+            watchQueue->removePath(path);
+    for (auto path : index.keys())
+        if (QFileInfo(path).isFile())
+            watchQueue->addPath(path);
+    sourceIndex = index;
+}
+
+void MainWindow::sourcesSettled()
+{
+    QSet<QString> affected;
+    for (auto path : pendingSources)
+        for (auto name : sourceIndex.value(path))
+            affected.insert(name);
+    pendingSources.clear();
+
+    // fingerprints are checked on the refresher threads, watch mode starts
+    // whatever turned out stale once they are back
+    QSet<SBYFile *> refresh;
+    for (auto name : affected) {
+        auto it = items.find(name);
+        if (it == items.end())
+            continue;
+        // the run stores the fingerprint it started with, check again once it is done
+        if (taskQueue->isRunning(name)) {
+            changedWhileRunning.insert(name);
+            continue;
+        }
+        SBYItem *item = it->second->getItem();
+        refresh.insert(item->isTop() ? static_cast<SBYFile *>(item) : static_cast<SBYTask *>(item)->getFile());
+        if (actionWatch->isChecked())
+            startWhenStale.insert(name);
+    }
+    for (auto file : refresh)
+        statusRefresher->refresh(file);
+}
+
+void MainWindow::statusRefreshed(QString fileName, SBYStatusMap statuses)
+{
+    auto fileIt = items.find(fileName);
+    if (fileIt == items.end())
+        return;
+    QSBYItem *fileItem = fileIt->second.get();
+    bool changed = false;
+    for (auto it = statuses.begin(); it != statuses.end(); ++it) {
+        auto item = items.find(it.key());
+        bool start = startWhenStale.remove(it.key());
+        // running tasks keep their live state until they finish
+        if (item == items.end() || taskQueue->isRunning(it.key()))
+            continue;
+        if (item->second->getItem()->setStatus(it.value())) {
+            changed = true;
+            if (item->second.get() != fileItem)
+                item->second->refreshView();
+        }
+        if (start && !item->second->getItem()->isUpToDate())
+            startTask(it.key());
+    }
+    if (!changed)
+        return;
+    SBYFile *file = static_cast<SBYFile *>(fileItem->getItem());
+    if (file->haveTasks())
+        file->updateSummary();
+    fileItem->refreshView();
+    cacheSaveTimer->start();
+}
+
+void MainWindow::setWatchMode(bool enabled)
+{
+    actionWatch->setChecked(enabled);
 }
 MainWindow::MainWindow(QString path, QWidget *parent) : QMainWindow(parent)
 {
     initBasenameResource();
     Scintilla::Catalogue::AddLexerModule(&lmSBY);
 
-    process = nullptr;
+    taskQueue = new TaskQueue(this);
+    taskMemoryLimit = 0;
+    jobServer = new JobServer(this);
+    jobServer->setTokens(taskQueue->getMaxJobs());
+    taskQueue->setJobServer(jobServer);
+    cacheSaveTimer = new QTimer(this);
+    cacheSaveTimer->setSingleShot(true);
+    cacheSaveTimer->setInterval(2000);
+    connect(cacheSaveTimer, &QTimer::timeout, this, &MainWindow::saveWorkspaceCache);
+    resumePending = false;
+    journalTimer = new QTimer(this);
+    journalTimer->setSingleShot(true);
+    journalTimer->setInterval(1000);
+    connect(journalTimer, &QTimer::timeout, this, &MainWindow::saveRunJournal);
+    fileLoader = new FileLoader(this);
+    connect(fileLoader, &FileLoader::loaded, this, &MainWindow::fileLoaded);
+    connect(fileLoader, &FileLoader::finished, this, &MainWindow::loadingFinished);
+    scanner = new ProjectScanner(this);
+    connect(scanner, &ProjectScanner::finished, this, &MainWindow::scanFinished);
+    statusRefresher = new StatusRefresher(this);
+    connect(statusRefresher, &StatusRefresher::refreshed, this, &MainWindow::statusRefreshed);
+    control = new ControlServer(this);
+    registerControlMethods();
+    workerPool = new WorkerPool(this);
+    connect(workerPool, &WorkerPool::changed, [=]() {
+        taskQueue->setRemoteSlots(workerPool->getSlots());
+        workerDisplay->setText("Workers: " + workerPool->getStatus() + " ");
+    });
 
     setObjectName(QStringLiteral("MainWindow"));
     resize(1024, 768);
@@ -135,21 +287,37 @@ MainWindow::MainWindow(QString path, QWidget *parent) : QMainWindow(parent)
     QSplitter *splitter_h = new QSplitter(Qt::Horizontal, centralWidget);
     QSplitter *splitter_v = new QSplitter(Qt::Vertical, splitter_h);
 
-    grid = new QGridLayout;
-
-    QWidget *container = new QWidget();    
-    container->setLayout(grid);
+    taskModel = new TaskModel(files, this);
+    taskModel->setRunningCheck([=](SBYItem *item) {
+        auto it = items.find(item->isTop() ? item->getRelativeName() : item->getRelativeName() + "#" + item->getName());
+        return it != items.end() && it->second->isRunning();
+    });
+    TaskDelegate *taskDelegate = new TaskDelegate(this);
+    connect(taskDelegate, &TaskDelegate::actionTriggered, [=](const QModelIndex &index, TaskDelegate::Action action) {
+        itemAction(taskModel->itemAt(index), action);
+    });
 
-    QScrollArea *scrollArea = new QScrollArea();
-    // scrollArea->setBackgroundRole(QPalette::Mid);
-    scrollArea->setWidget(container);
-    scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-    scrollArea->setMinimumWidth(400);
-    scrollArea->setMaximumWidth(400);
-    scrollArea->setWidgetResizable(true);
+    // rows are painted by the delegate, only the visible ones ever are
+    taskView = new QTreeView();
+    taskView->setModel(taskModel);
+    taskView->setItemDelegate(taskDelegate);
+    taskView->setHeaderHidden(true);
+    taskView->setUniformRowHeights(true);
+    taskView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    taskView->setSelectionMode(QAbstractItemView::SingleSelection);
+    taskView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    taskView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    taskView->setContextMenuPolicy(Qt::CustomContextMenu);
+    taskView->setMinimumWidth(400);
+    taskView->setMaximumWidth(400);
+    // files and tasks open, properties only on request
+    connect(taskModel, &QAbstractItemModel::modelReset, [=]() { taskView->expandToDepth(taskModel->isGrouped() ? 1 : 0); });
+    connect(taskView, &QTreeView::customContextMenuRequested, this, &MainWindow::taskContextMenu);
+    connect(taskView, &QTreeView::doubleClicked, [=](const QModelIndex &index) {
+        itemAction(taskModel->itemAt(index), TaskDelegate::Edit);
+    });
 
-    splitter_h->addWidget(scrollArea);
+    splitter_h->addWidget(taskView);
     splitter_h->addWidget(splitter_v);
     splitter_h->setCollapsible(0, false);
     splitter_h->setCollapsible(1, false);
@@ -167,10 +335,22 @@ MainWindow::MainWindow(QString path, QWidget *parent) : QMainWindow(parent)
     QFont f("unexistent");
     f.setStyleHint(QFont::Monospace);
 
-    log = new QPlainTextEdit();
-    log->setReadOnly(true);
-    log->setFont(f);
-    tabWidget->addTab(log, "Log");    
+    logView = new LogView(f);
+    tabWidget->addTab(logView, "Log");
+
+    queueView = new QTreeWidget();
+    queueView->setColumnCount(5);
+    queueView->setHeaderLabels(QStringList() << "Task" << "State" << "Estimate" << "Finish" << "Memory");
+    queueView->setRootIsDecorated(false);
+    tabWidget->addTab(queueView, "Queue");
+
+    connect(taskQueue, &TaskQueue::launch, this, &MainWindow::launchTask);
+    connect(taskQueue, &TaskQueue::changed, this, &MainWindow::updateQueueView);
+    connect(taskQueue, &TaskQueue::changed, [=]() { journalTimer->start(); });
+    connect(taskQueue, &TaskQueue::idle, [=]() {
+        actionPlay->setEnabled(true);
+        actionStop->setEnabled(false);
+    });
 
     centralTabWidget = new QTabWidget();
     centralTabWidget->setTabsClosable(true);
@@ -180,9 +360,8 @@ MainWindow::MainWindow(QString path, QWidget *parent) : QMainWindow(parent)
     splitter_v->addWidget(centralTabWidget);
     splitter_v->addWidget(tabWidget);
 
-    fileWatcher = new QFileSystemWatcher(this);
-    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::fileChanged);
-    connect(fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::directoryChanged);
+    watchQueue = new WatchQueue(this);
+    connect(watchQueue, &WatchQueue::changed, this, &MainWindow::watchedChanged);
 
     openLocation(path);
 
@@ -191,121 +370,147 @@ MainWindow::MainWindow(QString path, QWidget *parent) : QMainWindow(parent)
     
     QTimer *timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MainWindow::showTime);
+    connect(timer, &QTimer::timeout, this, &MainWindow::checkMemory);
     timer->start(1000);
 }
 
-void MainWindow::directoryChanged(const QString & path)
+void MainWindow::scanFinished(QStringList newFileList)
 {
-    QStringList newFileList = getFileList(currentFolder);
-
     QSet<QString> newDirSet = QSet<QString>::fromList(newFileList); 
     QSet<QString> currentDirSet = QSet<QString>::fromList(currentFileList);
     QSet<QString> newFiles = newDirSet - currentDirSet;
     QSet<QString> deletedFiles = currentDirSet - newDirSet;
 
-
-    QStringList newList = newFiles.toList();
     QStringList deleteList = deletedFiles.toList();
 
-    if(!newList.isEmpty())
-    {
-        for(auto name : newList) {
-            QString filename = QDir(currentFolder).filePath(name);
-            fileWatcher->addPath(filename);
-            std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(QFileInfo(filename));
-            f->parse();
-            f->update();
-            files.push_back(std::move(f));
-            fileMap.insert(filename, files.back().get());
-
-            grid->addWidget(generateFileBox(files.back().get()), (int)files.size(), 0);
+    // unchanged files are shown from the cache right away, the rest shows
+    // up as it gets parsed; both are checked again on the loader threads
+    for (auto name : newFileList) {
+        if (!newFiles.contains(name))
+            continue;
+        QFileInfo info(currentFolder.filePath(name));
+        watchQueue->addPath(info.absoluteFilePath());
+        QJsonObject cached = workspaceCache.entry(name);
+        if (WorkspaceCache::isCurrent(cached, info)) {
+            std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(info);
+            f->setRelativeName(name);
+            WorkspaceCache::restoreParsed(f.get(), cached, false);
+            WorkspaceCache::restoreStatus(f.get(), cached);
+            insertFile(std::move(f));
+        } else {
+            loadingFiles.insert(info.absoluteFilePath());
         }
+        fileLoader->load(info, cached);
     }
     if(!deleteList.isEmpty())
     {
         for(auto name : deleteList) {
             QString filename = QDir(currentFolder).filePath(name);
-            fileWatcher->removePath(filename);
+            watchQueue->removePath(filename);
+            if (loadingFiles.remove(filename))
+                continue;
+            if (!fileMap.contains(filename))
+                continue;
             SBYFile *file = fileMap[filename];
             for (auto const & task : file->getTasks())
             {
-                QString name = file->getName() + "#" + task->getName();
+                QString name = file->getRelativeName() + "#" + task->getName();
                 auto it = items.find(name);
                 if (it!=items.end()) {
                     items.erase(it);
                 }
+                taskQueue->remove(name);
+                logView->removeChannel(name);
             }
-            auto it = items.find(file->getName());
+            auto it = items.find(file->getRelativeName());
             if (it!=items.end()) {
                 items.erase(it);
             }
+            taskQueue->remove(file->getRelativeName());
+            logView->removeChannel(file->getRelativeName());
+            fileMap.remove(filename);
+            taskModel->removeFile(file);
             auto itFile = files.begin();
             while(itFile != files.end()) {
                 if (itFile->get()->getFullPath() == filename) {
-                    files.erase(itFile);
+                    itFile = files.erase(itFile);
                 }
                 else ++itFile;
             }
         }
     }    
+
+    // every scanned directory is watched, new files anywhere below trigger a rescan
+    QSet<QString> directories = QSet<QString>::fromList(scanner->getDirectories());
+    for (auto dir : watchedDirectories - directories)
+        watchQueue->removePath(dir);
+    for (auto dir : directories)
+        watchQueue->addPath(dir);
+    watchedDirectories = directories;
+
     currentFileList = newFileList;
+    if (!fileLoader->isLoading())
+        loadingFinished();
+    else if (!loadingFiles.isEmpty())
+        statusBar->showMessage(QString("Loading %1 files...").arg(loadingFiles.size()));
 }
 
-void MainWindow::fileChanged(const QString & filename)
+void MainWindow::watchedChanged(QStringList changedFiles, QStringList directories)
 {
-    SBYFile *file = fileMap[filename];
-    std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(QFileInfo(filename));
-    f->parse();
-    f->update();
-    QSet<QString> newTaskSet = f->getTasksSet(); 
-    QSet<QString> currTaskSet = file->getTasksSet(); 
-    QSet<QString> newTasks = newTaskSet - currTaskSet;
-    QSet<QString> deletedTasks = currTaskSet - newTaskSet;
-
-    if(!deletedTasks.isEmpty())
-    {
-        for(auto name : deletedTasks) {
-            QString n = file->getFileName() + "#" + name;
-            auto it = items.begin();
-            while(it != items.end()) {
-                if (it->second->getName() == n) {
-                    items.erase(it);
-                    break;                    
-                }
-                else ++it;
-            }
+    // new and deleted files show up through a rescan, everything that is
+    // left is parsed again in one pass on the loader threads
+    if (!directories.isEmpty())
+        scanner->scan(currentFolder);
+    for (auto filename : changedFiles) {
+        if (fileMap.contains(filename) || loadingFiles.contains(filename)) {
+            if (QFileInfo(filename).isFile())
+                fileLoader->load(QFileInfo(filename));
+        } else {
+            pendingSources.insert(filename);
         }
-    } 
-    
-    file->refresh();
+    }
+    if (!pendingSources.isEmpty())
+        sourcesSettled();
+}
 
-    if(!newTasks.isEmpty())
-    {
-        for(auto name : newTasks) {
-            QSBYItem *fileBox = items[file->getFileName()].get();
-            std::unique_ptr<QSBYItem> groupBox = std::make_unique<QSBYItem>(name, file->getTask(name), fileBox, this);
-            QString newname = groupBox->getName();
-
-            connect(groupBox.get(), &QSBYItem::appendLog, this, &MainWindow::appendLog);
-            connect(groupBox.get(), &QSBYItem::editOpen, this, &MainWindow::editOpen);
-            connect(groupBox.get(), &QSBYItem::previewOpen, this, &MainWindow::previewOpen);
-            connect(groupBox.get(), &QSBYItem::previewLog, this, &MainWindow::previewLog);
-            connect(groupBox.get(), &QSBYItem::taskExecuted, this, &MainWindow::taskExecuted);
-            connect(groupBox.get(), &QSBYItem::startTask, this, &MainWindow::startTask);
-            connect(groupBox.get(), &QSBYItem::previewSource, this, &MainWindow::previewSource);
-            connect(groupBox.get(), &QSBYItem::previewVCD, this, &MainWindow::previewVCD);
-
-
-            fileBox->layout()->addWidget(groupBox.get());            
-            items.emplace(std::make_pair(newname, std::move(groupBox)));
-        }
+// one parse per change, the model and the rows only pick up the difference
+void MainWindow::applyParsed(SBYFile *file, SBYFile &parsed)
+{
+    QString fileName = file->getRelativeName();
+    SBYFileDiff diff = file->diff(parsed);
+    for (auto name : diff.removed) {
+        items.erase(fileName + "#" + name);
+        taskQueue->remove(fileName + "#" + name);
+        logView->removeChannel(fileName + "#" + name);
+    }
+    // a file that gained tasks no longer runs on its own
+    if (!file->haveTasks() && parsed.haveTasks())
+        taskQueue->remove(fileName);
+
+    QSBYItem *fileItem = items[fileName].get();
+    taskModel->beginUpdateFile(file);
+    file->merge(parsed);
+    for (auto name : diff.added) {
+        std::unique_ptr<QSBYItem> taskItem = std::make_unique<QSBYItem>(file->getTask(name), fileItem, this);
+        connectItem(taskItem.get());
+        items.emplace(std::make_pair(taskItem->getName(), std::move(taskItem)));
     }
-    items[file->getFileName()]->refreshView();
+    taskModel->endUpdateFile();
+    fileItem->refreshView();
+    for (auto name : diff.changed)
+        if (!name.isEmpty())
+            items[fileName + "#" + name]->refreshView();
+    rebuildSourceIndex();
+    cacheSaveTimer->start();
 }
 
 void MainWindow::showTime()
 {
-    if (process==nullptr)  {
+    if (jobServer->isValid())
+        tokenDisplay->setText(QString("Tokens: %1 free, %2 in use ")
+                                      .arg(jobServer->getFreeTokens())
+                                      .arg(jobServer->getUsedTokens()));
+    if (taskQueue->isIdle())  {
         timeDisplay->setText("");
         return;
     }
@@ -318,7 +523,119 @@ void MainWindow::showTime()
     timeDisplay->setText(text);
 }
 
-MainWindow::~MainWindow() {}
+void MainWindow::checkMemory()
+{
+    QList<qint64> pids;
+    for (auto name : taskQueue->getRunning()) {
+        auto it = items.find(name);
+        if (it != items.end() && it->second->processId() > 0)
+            pids << it->second->processId();
+    }
+    if (pids.isEmpty())
+        return;
+    QMap<qint64, qint64> rss = ProcessInfo::treeRss(pids);
+    for (auto name : taskQueue->getRunning()) {
+        auto it = items.find(name);
+        if (it == items.end() || !rss.contains(it->second->processId()))
+            continue;
+        qint64 used = rss[it->second->processId()];
+        taskMemory[name] = used;
+        if (taskMemoryLimit > 0 && used > taskMemoryLimit)
+            it->second->killProcess("MEMOUT", QString("memory limit of %1 MB exceeded, %2 MB in use")
+                                                      .arg(taskMemoryLimit >> 20)
+                                                      .arg(used >> 20));
+    }
+    for (int i = 0; i < queueView->topLevelItemCount(); i++) {
+        QTreeWidgetItem *row = queueView->topLevelItem(i);
+        if (taskQueue->isRunning(row->text(0)) && taskMemory.contains(row->text(0)))
+            row->setText(4, QString("%1 MB").arg(taskMemory[row->text(0)] >> 20));
+    }
+}
+
+void MainWindow::refreshFingerprints()
+{
+    for (auto &file : files)
+        statusRefresher->refresh(file.get());
+}
+
+void MainWindow::setMemoryReserve(qint64 megabytes)
+{
+    taskQueue->setMemoryReserve(megabytes << 20);
+}
+
+void MainWindow::setTaskMemoryLimit(qint64 megabytes)
+{
+    taskMemoryLimit = megabytes << 20;
+}
+
+MainWindow::~MainWindow()
+{
+    if (cacheSaveTimer->isActive())
+        saveWorkspaceCache();
+}
+
+void MainWindow::saveWorkspaceCache()
+{
+    if (refreshLocation.isDir() && !fileLoader->isLoading())
+        workspaceCache.save(currentFolder, files);
+}
+
+void MainWindow::saveRunJournal()
+{
+    // the journal of this folder is only replaced once its runs were picked up
+    if (!refreshLocation.isDir() || resumePending)
+        return;
+    RunJournal journal;
+    for (auto name : taskQueue->getRunning()) {
+        auto it = items.find(name);
+        TaskRunner *runner = it != items.end() ? it->second->getRunner() : nullptr;
+        if (runner && runner->isDetached())
+            journal.running[name] = runner->detachedState();
+        else
+            // runs on workers end with the GUI, those start over
+            journal.queued << name;
+    }
+    for (auto name : taskQueue->getQueued())
+        journal.queued << name;
+    journal.save(currentFolder);
+}
+
+void MainWindow::resumeRuns()
+{
+    resumePending = false;
+    RunJournal journal;
+    journal.load(currentFolder);
+    int resumed = 0;
+    for (auto it = journal.running.begin(); it != journal.running.end(); ++it) {
+        auto item = items.find(it.key());
+        if (item == items.end() || item->second->isRunning())
+            continue;
+        // gone without an exit code means it was stopped, the work directory tells the rest
+        if (!item->second->attachSBYTask(RunJournal::directory(currentFolder), it.value()))
+            continue;
+        if (taskQueue->isIdle())
+            taskTimer->restart();
+        taskQueue->adopt(it.key(), it.value().startedAt, estimateRuntime(it.key()));
+        notifyStatus(it.key());
+        resumed++;
+    }
+    if (resumed) {
+        actionPlay->setEnabled(false);
+        actionStop->setEnabled(true);
+    }
+    int queued = 0;
+    for (auto name : journal.queued) {
+        if (items.find(name) == items.end())
+            continue;
+        startTask(name);
+        queued++;
+    }
+    if (resumed || queued)
+        appendLog(QString("---Picked up %1 running and %2 queued task(s) of an earlier session---\n")
+                          .arg(resumed)
+                          .arg(queued));
+    saveRunJournal();
+}
 
 void MainWindow::createMenusAndBars()
 {
@@ -328,9 +645,11 @@ void MainWindow::createMenusAndBars()
 
     menuBar = new QMenuBar();
     QMenu *menu_File = new QMenu("&File", menuBar);
+    QMenu *menu_Run = new QMenu("&Run", menuBar);
     QMenu *menu_Help = new QMenu("&Help", menuBar);
 
     menuBar->addAction(menu_File->menuAction());
+    menuBar->addAction(menu_Run->menuAction());
     menuBar->addAction(menu_Help->menuAction());
     setMenuBar(menuBar);
 
@@ -340,7 +659,25 @@ void MainWindow::createMenusAndBars()
     setStyleSheet("QStatusBar::item { border: 0px solid black }; ");
     timeDisplay = new QLabel();
     timeDisplay->setContentsMargins(0, 0, 0, 0);
+    tokenDisplay = new QLabel();
+    tokenDisplay->setContentsMargins(0, 0, 0, 0);
+    tokenDisplay->setToolTip("Jobserver tokens shared by all running tasks and their solvers");
+    cacheDisplay = new QLabel();
+    cacheDisplay->setContentsMargins(0, 0, 0, 0);
+    cacheDisplay->setToolTip("Results restored from the result cache instead of running sby");
+    auto showCache = [=](int hits, int misses) {
+        cacheDisplay->setText(QString("Cache: %1 hits, %2 misses ").arg(hits).arg(misses));
+    };
+    if (ResultCache::instance().isEnabled())
+        showCache(0, 0);
+    connect(&ResultCache::instance(), &ResultCache::countersChanged, this, showCache, Qt::QueuedConnection);
+    workerDisplay = new QLabel();
+    workerDisplay->setContentsMargins(0, 0, 0, 0);
+    workerDisplay->setToolTip("Worker daemons tasks are sent to, with running tasks and slots");
     statusBar = new QStatusBar();
+    statusBar->addPermanentWidget(workerDisplay);
+    statusBar->addPermanentWidget(cacheDisplay);
+    statusBar->addPermanentWidget(tokenDisplay);
     statusBar->addPermanentWidget(timeDisplay);
     setStatusBar(statusBar);
 
@@ -401,35 +738,240 @@ void MainWindow::createMenusAndBars()
 
     actionPlay = new QAction("Play", this);
     actionPlay->setIcon(QIcon(":/icons/resources/media-playback-start.png")); 
+    actionPlay->setShortcut(QKeySequence("F5"));
+    actionPlay->setStatusTip("Run all tasks that are not up to date");
     mainToolBar->addAction(actionPlay);
-    actionStop = new QAction("Stop", this);
+    menu_Run->addAction(actionPlay);
+    actionStop = new QAction("Stop all", this);
     actionStop->setIcon(QIcon(":/icons/resources/media-playback-stop.png"));    
+    actionStop->setShortcut(QKeySequence("Shift+F5"));
+    actionStop->setStatusTip("Drop queued tasks and stop all running tasks with their solvers");
     actionStop->setEnabled(false);
     mainToolBar->addAction(actionStop);
+    menu_Run->addAction(actionStop);
+    actionWatch = new QAction("Watch sources", this);
+    actionWatch->setIcon(QIcon(":/icons/resources/view-refresh.png"));
+    actionWatch->setCheckable(true);
+    actionWatch->setStatusTip("Rerun tasks automatically when one of their source files is saved");
+    mainToolBar->addAction(actionWatch);
+    menu_Run->addAction(actionWatch);
+    mainToolBar->addSeparator();
+    mainToolBar->addWidget(new QLabel(" Jobs: "));
+    jobsSpinBox = new QSpinBox();
+    jobsSpinBox->setRange(1, 1024);
+    jobsSpinBox->setValue(taskQueue->getMaxJobs());
+    jobsSpinBox->setToolTip("Number of tasks running in parallel, also shared with solvers through the jobserver");
+    connect(jobsSpinBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [=](int value) {
+        jobServer->setTokens(value);
+        taskQueue->setMaxJobs(value);
+    });
+    mainToolBar->addWidget(jobsSpinBox);
+    mainToolBar->addWidget(new QLabel(" Order: "));
+    orderComboBox = new QComboBox();
+    orderComboBox->addItem("File order", TaskQueue::FileOrder);
+    orderComboBox->addItem("Longest first", TaskQueue::LongestFirst);
+    orderComboBox->addItem("Shortest first", TaskQueue::ShortestFirst);
+    orderComboBox->setToolTip("Order of queued tasks, based on the runtime of their last run");
+    connect(orderComboBox, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [=](int index) {
+        taskQueue->setPolicy((TaskQueue::Policy)orderComboBox->itemData(index).toInt());
+    });
+    mainToolBar->addWidget(orderComboBox);
+    mainToolBar->addWidget(new QLabel(" Fail fast: "));
+    failFastComboBox = new QComboBox();
+    failFastComboBox->addItem("Off", FailFastOff);
+    failFastComboBox->addItem("Per file", FailFastFile);
+    failFastComboBox->addItem("Workspace", FailFastWorkspace);
+    failFastComboBox->setToolTip("Cancel queued and running tasks once a task fails");
+    mainToolBar->addWidget(failFastComboBox);
     connect(actionPlay, &QAction::triggered, [=]() { 
         for (auto & item : files)
         {
             if (item->haveTasks())  {
                 for(const auto & task : item->getTasks()) {
-                    if (task->getStatusColor()!=1)
-                        Q_EMIT startTask(item->getFileName() + "#" + task->getTaskName()); 
+                    if (!task->isUpToDate())
+                        Q_EMIT startTask(item->getRelativeName() + "#" + task->getTaskName()); 
                 }
             } else {
-                if (item->getStatusColor()!=1)
-                    Q_EMIT startTask(item->getFileName()); 
+                if (!item->isUpToDate())
+                    Q_EMIT startTask(item->getRelativeName()); 
             }
         }
     });   
     connect(actionStop, &QAction::triggered, [=]() { 
-        if (taskList.size()>0)  {        
-            QString name = taskList.front();        
-            taskList.clear();
-            taskList.push_back(name); // Put back one to finish
+        std::deque<QString> queued = taskQueue->getQueued();
+        taskQueue->clearQueued();
+        for (auto name : queued)
+            notifyStatus(name);
+        QStringList running = taskQueue->getRunning();
+        for (auto name : running)
             items[name]->stopProcess();
-        }         
      });
 }
 
+void MainWindow::setMaxJobs(int jobs)
+{
+    jobsSpinBox->setValue(jobs);
+}
+
+bool MainWindow::setControlSocket(QString path)
+{
+    if (!control->listen(path))
+        return false;
+    appendLog("Control socket listening on " + control->serverPath() + "\n");
+    return true;
+}
+
+QStringList MainWindow::taskNames()
+{
+    QStringList names;
+    for (auto &file : files) {
+        if (file->haveTasks()) {
+            for (const auto &task : file->getTasks())
+                names << file->getRelativeName() + "#" + task->getTaskName();
+        } else {
+            names << file->getRelativeName();
+        }
+    }
+    return names;
+}
+
+QStringList MainWindow::controlNames(const QJsonObject &params, QString &error)
+{
+    // "name" or "names", a file with tasks stands for all of them
+    QStringList requested;
+    if (params.contains("name"))
+        requested << params["name"].toString();
+    for (auto name : params["names"].toArray())
+        requested << name.toString();
+    if (requested.isEmpty())
+        error = "no task given";
+    QStringList all = taskNames();
+    QStringList names;
+    for (auto name : requested) {
+        QStringList matching;
+        for (auto task : all)
+            if (task == name || task.startsWith(name + "#"))
+                matching << task;
+        if (matching.isEmpty())
+            error = "unknown task " + name;
+        names << matching;
+    }
+    return names;
+}
+
+QJsonObject MainWindow::taskStatus(QString name)
+{
+    QJsonObject status;
+    status["name"] = name;
+    status["state"] = taskQueue->isRunning(name) ? "running" : taskQueue->isQueued(name) ? "queued" : "idle";
+    auto it = items.find(name);
+    if (it != items.end()) {
+        SBYItem *item = it->second->getItem();
+        status["status"] = item->getStatus();
+        status["time"] = item->getTimeSpent();
+        status["upToDate"] = item->isUpToDate();
+        status["stale"] = item->isStale();
+        if (!item->getProperties().isEmpty()) {
+            QJsonObject properties;
+            properties["pass"] = item->countProperties("PASS");
+            properties["fail"] = item->countProperties("FAIL");
+            properties["unknown"] = item->countProperties("UNKNOWN");
+            status["properties"] = properties;
+        }
+        SBYRunProgress &progress = item->getRunProgress();
+        if (taskQueue->isRunning(name) && !progress.engineStates.isEmpty()) {
+            status["step"] = progress.step;
+            status["depth"] = progress.depth;
+            QJsonObject engines;
+            for (auto it = progress.engineStates.begin(); it != progress.engineStates.end(); ++it)
+                engines[it.key()] = it.value();
+            status["engines"] = engines;
+        }
+    }
+    return status;
+}
+
+void MainWindow::notifyStatus(QString name)
+{
+    control->notify("status", taskStatus(name));
+}
+
+void MainWindow::registerControlMethods()
+{
+    control->addMethod("files", [=](const QJsonObject &, QString &) {
+        QJsonArray result;
+        for (auto &file : files) {
+            QJsonObject entry;
+            entry["file"] = file->getRelativeName();
+            entry["path"] = file->getFullPath();
+            QJsonArray tasks;
+            for (auto name : taskNames())
+                if (name == file->getRelativeName() || name.startsWith(file->getRelativeName() + "#"))
+                    tasks << name;
+            entry["tasks"] = tasks;
+            result << entry;
+        }
+        return QJsonValue(result);
+    });
+    control->addMethod("tasks", [=](const QJsonObject &, QString &) {
+        QJsonArray result;
+        for (auto name : taskNames())
+            result << taskStatus(name);
+        return QJsonValue(result);
+    });
+    control->addMethod("queue", [=](const QJsonObject &, QString &) {
+        QJsonObject result;
+        QJsonArray queued;
+        for (auto name : taskQueue->getQueued())
+            queued << name;
+        result["running"] = QJsonArray::fromStringList(taskQueue->getRunning());
+        result["queued"] = queued;
+        result["done"] = QJsonArray::fromStringList(taskQueue->getDone());
+        QJsonObject finish;
+        QMap<QString, int> predicted = taskQueue->predictFinish();
+        for (auto it = predicted.begin(); it != predicted.end(); ++it)
+            finish[it.key()] = it.value();
+        result["finish"] = finish;
+        return QJsonValue(result);
+    });
+    control->addMethod("start", [=](const QJsonObject &params, QString &error) {
+        QStringList names = controlNames(params, error);
+        if (!error.isEmpty())
+            return QJsonValue();
+        for (auto name : names)
+            startTask(name);
+        return QJsonValue(QJsonArray::fromStringList(names));
+    });
+    control->addMethod("stop", [=](const QJsonObject &params, QString &error) {
+        QStringList names = controlNames(params, error);
+        if (!error.isEmpty())
+            return QJsonValue();
+        QStringList queued;
+        for (auto name : names)
+            if (taskQueue->isQueued(name))
+                queued << name;
+        taskQueue->removeQueued(queued);
+        for (auto name : queued)
+            notifyStatus(name);
+        for (auto name : names)
+            if (taskQueue->isRunning(name))
+                items[name]->stopProcess();
+        return QJsonValue(QJsonArray::fromStringList(names));
+    });
+    control->addMethod("stopAll", [=](const QJsonObject &, QString &) {
+        actionStop->trigger();
+        return QJsonValue(true);
+    });
+}
+
+bool MainWindow::addWorker(QString address)
+{
+    if (!workerPool->addWorker(address))
+        return false;
+    workerDisplay->setText("Workers: " + workerPool->getStatus() + " ");
+    return true;
+}
+
 void MainWindow::save_sby(int index)
 {
     QWidget *current = centralTabWidget->widget(index);
@@ -450,8 +992,10 @@ void MainWindow::save_sby(int index)
                     centralTabWidget->tabBar()->setTabTextColor(index, Qt::black);
                     if (filepath.completeSuffix()=="sby") 
                         centralTabWidget->setTabIcon(index, QIcon(":/icons/resources/script_edit.png"));
-                    else
+                    else {
                         centralTabWidget->setTabIcon(index, QIcon(":/icons/resources/page_code.png"));
+                        refreshFingerprints();
+                    }
                 }
             }
         }
@@ -537,68 +1081,256 @@ bool MainWindow::closeTab(int index, bool forceSave) {
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     event->ignore();
-    if (QMessageBox::Yes == QMessageBox(QMessageBox::Information, "SBY Gui", "Are you sure you want to quit?", QMessageBox::Yes|QMessageBox::No).exec()) 
+    int detached = 0;
+    for (auto &it : items)
+        if (it.second->getRunner() && it.second->getRunner()->isDetached())
+            detached++;
+    QString question = "Are you sure you want to quit?";
+    if (detached && !resumePending)
+        question += QString("\n%1 running task(s) carry on in the background and are picked up again "
+                            "the next time this folder is opened.").arg(detached);
+    if (QMessageBox::Yes == QMessageBox(QMessageBox::Information, "SBY Gui", question, QMessageBox::Yes|QMessageBox::No).exec()) 
     {
         close_all();
+        // only once the journal is written, nothing would find them again otherwise
+        if (!resumePending) {
+            saveRunJournal();
+            for (auto &it : items)
+                if (it.second->getRunner())
+                    it.second->getRunner()->release();
+        }
         event->accept();    
     }    
 }
 
-void MainWindow::taskExecuted()
+void MainWindow::taskExecuted(QString name)
 {   
-    taskList.pop_front();
-    if (taskList.size()>0)  {        
-        QString name = taskList.front();        
-        items[name]->runSBYTask();
-    } else {
-        actionPlay->setEnabled(true); 
-        actionStop->setEnabled(false); 
+    // before finished(), so nothing affected gets started in the freed slot
+    applyFailFast(name);
+    taskQueue->finished(name);
+    notifyStatus(name);
+    cacheSaveTimer->start();
+    auto it = items.find(name);
+    if (changedWhileRunning.remove(name) && it != items.end()) {
+        SBYItem *item = it->second->getItem();
+        if (actionWatch->isChecked())
+            startWhenStale.insert(name);
+        statusRefresher->refresh(item->isTop() ? static_cast<SBYFile *>(item) : static_cast<SBYTask *>(item)->getFile());
     }
 }
 
+void MainWindow::applyFailFast(QString name)
+{
+    FailFast scope = (FailFast)failFastComboBox->currentData().toInt();
+    auto it = items.find(name);
+    if (scope == FailFastOff || it == items.end())
+        return;
+    SBYItem *item = it->second->getItem();
+    if (item->getStatus() != "FAIL" && item->getStatus() != "ERROR")
+        return;
+
+    auto affected = [=](const QString &other) {
+        if (other == name)
+            return false;
+        if (scope == FailFastWorkspace)
+            return true;
+        return other == item->getRelativeName() || other.startsWith(item->getRelativeName() + "#");
+    };
+    QStringList cancelled;
+    for (auto other : taskQueue->getQueued())
+        if (affected(other))
+            cancelled << other;
+    taskQueue->removeQueued(cancelled);
+    for (auto other : cancelled)
+        notifyStatus(other);
+    QStringList running = taskQueue->getRunning();
+    for (auto other : running) {
+        if (affected(other)) {
+            items[other]->stopProcess();
+            cancelled << other;
+        }
+    }
+    if (!cancelled.isEmpty())
+        appendLog(QString("---FAIL FAST: %1 returned %2, cancelled %3 task(s)---\n")
+                          .arg(name)
+                          .arg(item->getStatus())
+                          .arg(cancelled.size()));
+}
+
+void MainWindow::setFailFast(FailFast scope)
+{
+    failFastComboBox->setCurrentIndex(failFastComboBox->findData(scope));
+}
+
 void MainWindow::startTask(QString name)
 {   
+    if (taskQueue->isIdle())
+        taskTimer->restart();
     actionPlay->setEnabled(false); 
     actionStop->setEnabled(true);
-    if (std::find(taskList.begin(),taskList.end(),name) == taskList.end()) 
-    {
-        taskList.push_back(name);
-        if (taskList.size()==1)         
-        {
-            items[name]->runSBYTask();
+    if (taskQueue->enqueue(name, estimateRuntime(name)))
+        notifyStatus(name);
+}
+
+int MainWindow::estimateRuntime(QString name)
+{
+    auto it = items.find(name);
+    if (it == items.end())
+        return 60;
+    SBYItem *item = it->second->getItem();
+    if (item->getTimeSpent() >= 0)
+        return item->getTimeSpent();
+
+    // no history, use the average of the same file first, then of the workspace
+    int fileTotal = 0, fileCount = 0, total = 0, count = 0;
+    for (auto &file : files) {
+        if (file->haveTasks()) {
+            for (const auto &task : file->getTasks()) {
+                if (task->getTimeSpent() < 0)
+                    continue;
+                total += task->getTimeSpent();
+                count++;
+                if (file->getRelativeName() == item->getRelativeName()) {
+                    fileTotal += task->getTimeSpent();
+                    fileCount++;
+                }
+            }
+        } else if (file->getTimeSpent() >= 0) {
+            total += file->getTimeSpent();
+            count++;
         }
     }
+    if (fileCount)
+        return fileTotal / fileCount;
+    if (count)
+        return total / count;
+    return 60;
+}
+
+void MainWindow::launchTask(QString name)
+{
+    auto it = items.find(name);
+    if (it == items.end()) {
+        taskQueue->finished(name);
+        return;
+    }
+    // counted against the worker slots, it must not end up running locally on top of maxJobs
+    if (taskQueue->isRemote(name) && workerPool->getFreeSlots() == 0) {
+        taskQueue->remoteUnavailable(name);
+        return;
+    }
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    jobServer->addToEnvironment(env);
+    notifyStatus(name);
+    QString runDirectory = refreshLocation.isDir() ? RunJournal::directory(currentFolder) : QString();
+    it->second->runSBYTask(env, taskQueue->isRemote(name) ? workerPool : nullptr, runDirectory);
 }
 
-QGroupBox *MainWindow::generateFileBox(SBYFile *file)
+void MainWindow::updateQueueView()
 {
-    std::unique_ptr<QSBYItem> fileBox = std::make_unique<QSBYItem>(file->getName(), file, nullptr, this);
-    connect(fileBox.get(), &QSBYItem::appendLog, this, &MainWindow::appendLog);
-    connect(fileBox.get(), &QSBYItem::editOpen, this, &MainWindow::editOpen);
-    connect(fileBox.get(), &QSBYItem::previewOpen, this, &MainWindow::previewOpen);
-    connect(fileBox.get(), &QSBYItem::previewLog, this, &MainWindow::previewLog);
-    connect(fileBox.get(), &QSBYItem::taskExecuted, this, &MainWindow::taskExecuted);
-    connect(fileBox.get(), &QSBYItem::startTask, this, &MainWindow::startTask);
-    connect(fileBox.get(), &QSBYItem::previewSource, this, &MainWindow::previewSource);
-    connect(fileBox.get(), &QSBYItem::previewVCD, this, &MainWindow::previewVCD);
+    QMap<QString, int> finish = taskQueue->predictFinish();
+    QDateTime now = QDateTime::currentDateTime();
+    int last = 0;
+    queueView->clear();
+    for (auto name : taskQueue->getRunning()) {
+        new QTreeWidgetItem(queueView, QStringList() << name << "Running"
+                                                     << QString("%1 sec").arg(taskQueue->getEstimate(name))
+                                                     << now.addSecs(finish[name]).toString("hh:mm:ss"));
+        last = std::max(last, finish[name]);
+    }
+    for (auto name : taskQueue->getQueued()) {
+        new QTreeWidgetItem(queueView, QStringList() << name << "Queued"
+                                                     << QString("%1 sec").arg(taskQueue->getEstimate(name))
+                                                     << now.addSecs(finish[name]).toString("hh:mm:ss"));
+        last = std::max(last, finish[name]);
+    }
+    for (auto name : taskQueue->getDone())
+        new QTreeWidgetItem(queueView, QStringList() << name << "Done");
+    queueView->resizeColumnToContents(0);
+    showTime();
+    QString message = QString("%1 running, %2 queued, %3 done")
+                              .arg(taskQueue->getRunning().size())
+                              .arg(taskQueue->getQueued().size())
+                              .arg(taskQueue->getDone().size());
+    if (!taskQueue->isIdle())
+        message += ", predicted finish at " + now.addSecs(last).toString("hh:mm:ss");
+    if (taskQueue->isWaitingForMemory())
+        message += ", waiting for free memory";
+    statusBar->showMessage(message);
+}
 
+void MainWindow::addFileItems(SBYFile *file)
+{
+    std::unique_ptr<QSBYItem> fileItem = std::make_unique<QSBYItem>(file, nullptr, this);
+    connectItem(fileItem.get());
     for (auto const & task : file->getTasks())
     {
-        std::unique_ptr<QSBYItem> groupBox = std::make_unique<QSBYItem>(task->getName(), task.get(), fileBox.get(), this);
-        QString name = groupBox->getName();
-        connect(groupBox.get(), &QSBYItem::appendLog, this, &MainWindow::appendLog);
-        connect(groupBox.get(), &QSBYItem::editOpen, this, &MainWindow::editOpen);
-        connect(groupBox.get(), &QSBYItem::previewOpen, this, &MainWindow::previewOpen);
-        connect(groupBox.get(), &QSBYItem::previewLog, this, &MainWindow::previewLog);
-        connect(groupBox.get(), &QSBYItem::taskExecuted, this, &MainWindow::taskExecuted);
-        connect(groupBox.get(), &QSBYItem::startTask, this, &MainWindow::startTask);
-        connect(groupBox.get(), &QSBYItem::previewSource, this, &MainWindow::previewSource);
-        connect(groupBox.get(), &QSBYItem::previewVCD, this, &MainWindow::previewVCD);
-        fileBox->layout()->addWidget(groupBox.get());
-        items.emplace(std::make_pair(name, std::move(groupBox)));
-    }
-    items.emplace(std::make_pair(file->getName(), std::move(fileBox)));
-    return items[file->getName()].get();
+        std::unique_ptr<QSBYItem> taskItem = std::make_unique<QSBYItem>(task.get(), fileItem.get(), this);
+        connectItem(taskItem.get());
+        items.emplace(std::make_pair(taskItem->getName(), std::move(taskItem)));
+    }
+    items.emplace(std::make_pair(file->getRelativeName(), std::move(fileItem)));
+}
+
+void MainWindow::itemAction(SBYItem *item, TaskDelegate::Action action)
+{
+    if (!item)
+        return;
+    QString name = item->isTop() ? item->getRelativeName() : item->getRelativeName() + "#" + item->getName();
+    auto it = items.find(name);
+    if (it == items.end())
+        return;
+    switch (action) {
+    case TaskDelegate::Play: it->second->play(); break;
+    case TaskDelegate::Stop: it->second->stopProcess(); break;
+    case TaskDelegate::Edit: it->second->edit(); break;
+    case TaskDelegate::Log: it->second->showLog(); break;
+    case TaskDelegate::Files: it->second->showFiles(); break;
+    case TaskDelegate::Wave: it->second->showWave(); break;
+    }
+}
+
+void MainWindow::taskContextMenu(const QPoint &pos)
+{
+    QModelIndex index = taskView->indexAt(pos);
+    SBYItem *item = taskModel->itemAt(index);
+    if (!item)
+        return;
+    bool running = index.data(TaskModel::RunningRole).toBool();
+    QMenu menu(this);
+    for (auto action : TaskDelegate::actions(item)) {
+        QAction *entry = menu.addAction(TaskDelegate::actionIcon(action, item), TaskDelegate::actionName(action, item));
+        entry->setEnabled(TaskDelegate::isEnabled(action, item, running));
+        connect(entry, &QAction::triggered, [=]() { itemAction(item, action); });
+    }
+    menu.exec(taskView->viewport()->mapToGlobal(pos));
+}
+
+void MainWindow::connectItem(QSBYItem *item)
+{
+    QString name = item->getName();
+    SBYItem *sbyItem = item->getItem();
+    connect(item, &QSBYItem::changed, [=]() { taskModel->itemChanged(sbyItem); });
+    connect(item, &QSBYItem::progress, [=]() { notifyStatus(name); });
+    connect(item, &QSBYItem::sbyEvent, [=](SBYEvent event) {
+        static const char *types[] = {"engine", "step", "assert", "engine-status", "summary", "done"};
+        control->notify("event", QJsonObject{{"name", name},
+                                             {"type", types[event.type]},
+                                             {"time", event.time.toString("HH:mm:ss")},
+                                             {"engine", event.engine},
+                                             {"text", event.text}});
+    });
+    connect(item, &QSBYItem::appendLog, [=](QString data) {
+        logView->append(name, data);
+        control->notify("log", QJsonObject{{"name", name}, {"data", data}});
+    });
+    connect(item, &QSBYItem::editOpen, this, &MainWindow::editOpen);
+    connect(item, &QSBYItem::previewOpen, this, &MainWindow::previewOpen);
+    connect(item, &QSBYItem::previewLog, this, &MainWindow::previewLog);
+    connect(item, &QSBYItem::taskExecuted, this, &MainWindow::taskExecuted);
+    connect(item, &QSBYItem::startTask, this, &MainWindow::startTask);
+    connect(item, &QSBYItem::previewSource, this, &MainWindow::previewSource);
+    connect(item, &QSBYItem::previewVCD, this, &MainWindow::previewVCD);
 }
 
 const char *MonospaceFont()
@@ -784,11 +1516,13 @@ void MainWindow::previewOpen(QString content, QString fileName, QString taskName
     centralTabWidget->setCurrentIndex(centralTabWidget->count() - 1);
 }
 
-void MainWindow::previewLog(QString content, QString fileName, QString taskName, bool reloadOnly)
+// the log text is only read from the result file for a tab that shows it
+void MainWindow::previewLog(QString itemName, bool reloadOnly)
 {
-    QString name = fileName;
-    if (!taskName.isEmpty()) name+= "#" + taskName;
-    name += ".log";
+    auto item = items.find(itemName);
+    if (item == items.end())
+        return;
+    QString name = itemName + ".log";
  
     for(int i=0;i<centralTabWidget->count();i++) {
         if(centralTabWidget->tabText(i) == name) { 
@@ -801,7 +1535,7 @@ void MainWindow::previewLog(QString content, QString fileName, QString taskName,
                     {
                         ScintillaEdit *editor = (ScintillaEdit*)current;
                         editor->setReadOnly(false);
-                        editor->setText(content.toLatin1().data());
+                        editor->setText(item->second->getItem()->getPreviousLog().toLatin1().data());
                         editor->setUndoCollection(true);
                         editor->setSavePoint();
                         editor->gotoPos(0);
@@ -814,15 +1548,16 @@ void MainWindow::previewLog(QString content, QString fileName, QString taskName,
     }
     if (reloadOnly) return;
 
-    ScintillaEdit *editor = openEditorText(content, 0);
+    ScintillaEdit *editor = openEditorText(item->second->getItem()->getPreviousLog(), 0);
     editor->setReadOnly(true);
 
     centralTabWidget->addTab(editor, QIcon(":/icons/resources/book.png"), name);
     centralTabWidget->setCurrentIndex(centralTabWidget->count() - 1);
 }
 
-void MainWindow::previewSource(QString fileName, bool reloadOnly)
+void MainWindow::previewSource(QString path, bool reloadOnly)
 {
+    QString fileName = currentFolder.relativeFilePath(QFileInfo(currentFolder, path).absoluteFilePath());
     for(int i=0;i<centralTabWidget->count();i++) {
         if(centralTabWidget->tabText(i) == fileName) { 
             centralTabWidget->setCurrentIndex(i); 
@@ -925,9 +1660,7 @@ void MainWindow::editOpen(QString path, QString fileName, bool reloadOnly)
 
 void MainWindow::appendLog(QString logline)
 {
-    log->moveCursor(QTextCursor::End);
-    log->insertPlainText (logline);
-    log->moveCursor(QTextCursor::End);
+    logView->append(QString(), logline);
 }
 
 void MainWindow::refreshView()
@@ -20,7 +20,6 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
-#include <QGroupBox>
 #include <QMainWindow>
 #include <QMenu>
 #include <QMenuBar>
@@ -33,12 +32,29 @@
 #include <QProgressBar>
 #include <QLabel>
 #include <QTime>
-#include <QFileSystemWatcher>
 #include <QFileInfo>
 #include <QDir>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QTreeWidget>
+#include <QTreeView>
+#include <QTimer>
+#include <QSet>
 #include <map>
-#include <deque>
 #include "qsbyitem.h"
+#include "jobserver.h"
+#include "taskqueue.h"
+#include "workerpool.h"
+#include "controlserver.h"
+#include "fileloader.h"
+#include "workspacecache.h"
+#include "runjournal.h"
+#include "watchqueue.h"
+#include "projectscanner.h"
+#include "statusrefresher.h"
+#include "taskdelegate.h"
+#include "taskmodel.h"
+#include "logview.h"
 
 class ScintillaEdit;
 
@@ -47,19 +63,38 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
   public:
+    enum FailFast
+    {
+        FailFastOff,
+        FailFastFile,
+        FailFastWorkspace
+    };
+
     explicit MainWindow(QString path, QWidget *parent = 0);
     virtual ~MainWindow();
 
+    void setMaxJobs(int jobs);
+    void setMemoryReserve(qint64 megabytes);
+    void setTaskMemoryLimit(qint64 megabytes);
+    void setLogLineLimit(int lines) { logView->setLineLimit(lines); }
+    void setFailFast(FailFast scope);
+    void setWatchMode(bool enabled);
+    void setDiscoveryFilters(QStringList include, QStringList exclude);
+    bool addWorker(QString address);
+    bool setControlSocket(QString path);
+
   protected:
     void createMenusAndBars();
-    QGroupBox *generateFileBox(SBYFile *file);
+    void addFileItems(SBYFile *file);
+    void insertFile(std::unique_ptr<SBYFile> f);
+    void itemAction(SBYItem *item, TaskDelegate::Action action);
+    void taskContextMenu(const QPoint &pos);
 
     void openLocation(QFileInfo path);
-    void removeLayoutItems(QLayout* layout);
     void editOpen(QString path, QString fileName, bool reloadOnly);
     void previewOpen(QString content, QString fileName, QString taskName, bool reloadOnly);
-    void previewLog(QString content, QString fileName, QString taskName, bool reloadOnly);
-    void previewSource(QString fileName, bool reloadOnly);
+    void previewLog(QString itemName, bool reloadOnly);
+    void previewSource(QString path, bool reloadOnly);
     void previewVCD(QString fileName);
     ScintillaEdit *openEditor(int lexer);
     ScintillaEdit *openEditorFile(QString fullpath);
@@ -67,14 +102,33 @@ class MainWindow : public QMainWindow
     void refreshView();
     void appendLog(QString logline);
     void showTime();
+    void checkMemory();
     virtual void closeEvent(QCloseEvent * event);
     void save_sby(int index);
     bool closeTab(int index, bool forceSave);
-    QStringList getFileList(QDir path);
+    int estimateRuntime(QString name);
+    void refreshFingerprints();
+    void applyFailFast(QString name);
+    void rebuildSourceIndex();
+    void sourcesSettled();
+    QStringList taskNames();
+    QStringList controlNames(const QJsonObject &params, QString &error);
+    QJsonObject taskStatus(QString name);
+    void notifyStatus(QString name);
+    void registerControlMethods();
+    void fileLoaded(SBYFile *file);
+    void loadingFinished();
+    void saveWorkspaceCache();
+    void saveRunJournal();
+    void resumeRuns();
+    void applyParsed(SBYFile *file, SBYFile &parsed);
+    void connectItem(QSBYItem *item);
   protected Q_SLOTS:
     void about();
-    void taskExecuted();
+    void taskExecuted(QString name);
     void startTask(QString name);
+    void launchTask(QString name);
+    void updateQueueView();
 
     void open_folder();
     void save_file();
@@ -82,8 +136,9 @@ class MainWindow : public QMainWindow
     void close_editor();
     void close_all();
 
-    void directoryChanged(const QString & path);
-    void fileChanged(const QString & path);
+    void scanFinished(QStringList files);
+    void watchedChanged(QStringList files, QStringList directories);
+    void statusRefreshed(QString fileName, SBYStatusMap statuses);
     void marginClicked(int position, int modifiers, int margin);
   protected:
     QTabWidget *tabWidget;
@@ -93,7 +148,8 @@ class MainWindow : public QMainWindow
     QToolBar *mainToolBar;
     QStatusBar *statusBar;
 
-    QGridLayout *grid;
+    QTreeView *taskView;
+    TaskModel *taskModel;
 
     QDir currentFolder;
 
@@ -109,21 +165,46 @@ class MainWindow : public QMainWindow
 
     QAction *actionPlay;
     QAction *actionStop;
+    QAction *actionWatch;
+    QSpinBox *jobsSpinBox;
+    QComboBox *orderComboBox;
+    QComboBox *failFastComboBox;
 
-    QProcess *process;
-    QPlainTextEdit *log;
+    LogView *logView;
+    QTreeWidget *queueView;
     QLabel *timeDisplay;
+    QLabel *tokenDisplay;
+    QLabel *cacheDisplay;
+    QLabel *workerDisplay;
     QFileInfo refreshLocation;
 
     QTime *taskTimer;
 
-    QFileSystemWatcher *fileWatcher;
+    WatchQueue *watchQueue;
 
     QStringList currentFileList;
     std::vector<std::unique_ptr<SBYFile>> files;
     QMap<QString, SBYFile*> fileMap;
     std::map<QString, std::unique_ptr<QSBYItem>> items;
-    std::deque<QString> taskList;
+    TaskQueue *taskQueue;
+    JobServer *jobServer;
+    WorkerPool *workerPool;
+    ControlServer *control;
+    FileLoader *fileLoader;
+    QSet<QString> loadingFiles;
+    ProjectScanner *scanner;
+    QSet<QString> watchedDirectories;
+    StatusRefresher *statusRefresher;
+    QSet<QString> startWhenStale;
+    QSet<QString> changedWhileRunning;
+    WorkspaceCache workspaceCache;
+    QTimer *cacheSaveTimer;
+    QTimer *journalTimer;
+    bool resumePending;
+    qint64 taskMemoryLimit;
+    QMap<QString, qint64> taskMemory;
+    QMap<QString, QStringList> sourceIndex;
+    QSet<QString> pendingSources;
 };
 
 #endif // MAINWINDOW_H
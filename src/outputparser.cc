@@ -0,0 +1,153 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "outputparser.h"
+#include <QRegularExpression>
+
+bool SBYRunProgress::apply(const SBYEvent &event)
+{
+    int previous = step;
+    QString state;
+    switch (event.type) {
+    case SBYEvent::EngineStarted:
+        engineModes[event.engine] = event.text;
+        state = "started";
+        break;
+    case SBYEvent::Step:
+        // induction counts down from the depth, only the base case says how far the run got
+        if (!event.induction && event.step > step)
+            step = event.step;
+        state = (event.induction ? "induction step " : "step ") + QString::number(event.step);
+        break;
+    case SBYEvent::AssertFailed:
+        state = "assert failed";
+        break;
+    case SBYEvent::EngineStatus:
+        state = event.text;
+        break;
+    case SBYEvent::Summary:
+    case SBYEvent::Done:
+        return false;
+    }
+    bool changed = step != previous || engineStates.value(event.engine) != state;
+    engineStates[event.engine] = state;
+    return changed;
+}
+
+int SBYRunProgress::percentage()
+{
+    if (step < 0 || depth <= 0)
+        return -1;
+    return qMin(99, (step + 1) * 100 / depth);
+}
+
+void OutputParser::reset()
+{
+    partial.clear();
+    engines.clear();
+}
+
+QList<SBYEvent> OutputParser::feed(const QString &chunk)
+{
+    QList<SBYEvent> events;
+    int start = 0;
+    int end;
+    while ((end = chunk.indexOf('\n', start)) != -1) {
+        if (partial.isEmpty()) {
+            parseLine(chunk.mid(start, end - start), events);
+        } else {
+            partial += chunk.midRef(start, end - start);
+            parseLine(partial, events);
+            partial.clear();
+        }
+        start = end + 1;
+    }
+    partial += chunk.midRef(start);
+    return events;
+}
+
+// SBY 14:31:02 [demo_prove] engine_0.basecase: ##   0:00:00  Checking assertions in step 5..
+void OutputParser::parseLine(const QString &line, QList<SBYEvent> &events)
+{
+    if (!line.startsWith("SBY "))
+        return;
+    int bracket = line.indexOf("] ");
+    if (bracket < 0)
+        return;
+    QString message = line.mid(bracket + 2);
+    if (message.endsWith('\r'))
+        message.chop(1);
+    SBYEvent event{SBYEvent::Summary, QTime::fromString(line.mid(4, 8), "HH:mm:ss"), QString(), -1, false, QString()};
+    if (!event.time.isValid())
+        event.time = QTime::currentTime();
+
+    if (message.startsWith("engine_")) {
+        int colon = message.indexOf(": ");
+        if (colon < 0)
+            return;
+        event.engine = message.left(colon);
+        int dot = event.engine.indexOf('.');
+        if (dot >= 0)
+            event.engine.truncate(dot);
+        QString text = message.mid(colon + 2);
+        if (!engines.contains(event.engine)) {
+            engines.insert(event.engine);
+            event.type = SBYEvent::EngineStarted;
+            event.text = text;
+            events << event;
+            return;
+        }
+        if (text.startsWith("##")) {
+            // drop the elapsed time smtbmc puts in front
+            static QRegularExpression time("^##\\s+\\S+\\s+");
+            text = text.mid(time.match(text).capturedLength());
+            if (text.contains(" in step ")) {
+                static QRegularExpression step("^(Checking assertions|Checking assumptions|Trying induction) in step (\\d+)");
+                QRegularExpressionMatch match = step.match(text);
+                if (!match.hasMatch())
+                    return;
+                event.type = SBYEvent::Step;
+                event.induction = match.capturedRef(1) == QLatin1String("Trying induction");
+                event.step = match.capturedRef(2).toInt();
+                events << event;
+            } else if (text.startsWith("Assert failed") || text.startsWith("BMC failed")) {
+                event.type = SBYEvent::AssertFailed;
+                event.text = text;
+                events << event;
+            }
+            return;
+        }
+        if (text.startsWith("Status returned by engine")) {
+            event.type = SBYEvent::EngineStatus;
+            event.text = text.mid(text.indexOf(':') + 1).trimmed();
+            events << event;
+        }
+        return;
+    }
+    if (message.startsWith("summary: ")) {
+        event.type = SBYEvent::Summary;
+        event.text = message.mid(9);
+        events << event;
+    } else if (message.startsWith("DONE (")) {
+        event.type = SBYEvent::Done;
+        event.text = message.mid(6).section(',', 0, 0).section(')', 0, 0);
+        events << event;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef OUTPUTPARSER_H
+#define OUTPUTPARSER_H
+
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+#include <QSet>
+#include <QString>
+#include <QTime>
+
+// Something sby reported while running a task
+struct SBYEvent
+{
+    enum Type
+    {
+        EngineStarted,
+        Step,
+        AssertFailed,
+        EngineStatus,
+        Summary,
+        Done
+    };
+
+    Type type;
+    QTime time;
+    QString engine;
+    // step events: the step, and whether it is an induction step
+    int step;
+    bool induction;
+    // engine mode, failed assertion, engine status, summary line or final status
+    QString text;
+};
+
+Q_DECLARE_METATYPE(SBYEvent)
+
+// Where a run is, as far as the output tells
+struct SBYRunProgress
+{
+    int step = -1;
+    int depth = 0;
+    QMap<QString, QString> engineModes;
+    QMap<QString, QString> engineStates;
+
+    // true when anything shown for the run changed
+    bool apply(const SBYEvent &event);
+    int percentage();
+};
+
+// Turns sby output into events. Output arrives in chunks that may end in
+// the middle of a line, the rest is kept until the next chunk. Lines are
+// matched with plain string checks first, chatty engines print thousands.
+class OutputParser
+{
+  public:
+    QList<SBYEvent> feed(const QString &chunk);
+    void reset();
+
+  protected:
+    void parseLine(const QString &line, QList<SBYEvent> &events);
+
+    QString partial;
+    QSet<QString> engines;
+};
+
+#endif // OUTPUTPARSER_H
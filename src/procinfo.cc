@@ -0,0 +1,156 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "procinfo.h"
+#include <QDir>
+#include <QFile>
+#include <QMultiMap>
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+static QByteArray readProcFile(const QString &name)
+{
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+struct ProcessEntry
+{
+    qint64 pid;
+    qint64 ppid;
+    qint64 session;
+};
+
+static QList<ProcessEntry> listProcesses()
+{
+    QList<ProcessEntry> list;
+#ifdef Q_OS_LINUX
+    QDir proc("/proc");
+    for (auto entry : proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        bool ok;
+        qint64 pid = entry.toLongLong(&ok);
+        if (!ok)
+            continue;
+        // "pid (comm) state ppid pgrp session ...", comm may contain spaces and brackets
+        QByteArray stat = readProcFile("/proc/" + entry + "/stat");
+        int end = stat.lastIndexOf(')');
+        if (end < 0)
+            continue;
+        QList<QByteArray> fields = stat.mid(end + 2).split(' ');
+        if (fields.size() < 4)
+            continue;
+        list << ProcessEntry{pid, fields[1].toLongLong(), fields[3].toLongLong()};
+    }
+#endif
+    return list;
+}
+
+// children of pid plus anything left in its session, tasks are started as
+// session leaders so this also covers solvers orphaned by a dead sby
+static QList<qint64> collectTree(const QList<ProcessEntry> &list, qint64 pid)
+{
+    QList<qint64> tree;
+    if (pid <= 0)
+        return tree;
+    QMultiMap<qint64, qint64> children;
+    tree << pid;
+    for (auto entry : list) {
+        children.insert(entry.ppid, entry.pid);
+        if (entry.session == pid && entry.pid != pid)
+            tree << entry.pid;
+    }
+    for (int i = 0; i < tree.size(); i++) {
+        for (auto child : children.values(tree[i]))
+            if (!tree.contains(child))
+                tree << child;
+    }
+    return tree;
+}
+
+qint64 ProcessInfo::treeRss(qint64 pid)
+{
+    return treeRss(QList<qint64>() << pid).value(pid, -1);
+}
+
+QMap<qint64, qint64> ProcessInfo::treeRss(const QList<qint64> &pids)
+{
+    // one scan of /proc for all trees, this runs every second for every task
+    QMap<qint64, qint64> rss;
+#ifdef Q_OS_LINUX
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    QList<ProcessEntry> list = listProcesses();
+    for (auto pid : pids) {
+        if (pid <= 0)
+            continue;
+        qint64 total = 0;
+        for (auto p : collectTree(list, pid)) {
+            QList<QByteArray> fields = readProcFile(QString("/proc/%1/statm").arg(p)).split(' ');
+            if (fields.size() > 1)
+                total += fields[1].toLongLong() * pageSize;
+        }
+        rss[pid] = total;
+    }
+#else
+    Q_UNUSED(pids);
+#endif
+    return rss;
+}
+
+qint64 ProcessInfo::availableMemory()
+{
+#ifdef Q_OS_LINUX
+    for (auto line : readProcFile("/proc/meminfo").split('\n')) {
+        if (line.startsWith("MemAvailable:"))
+            return line.mid(13).trimmed().split(' ').first().toLongLong() * 1024;
+    }
+#endif
+    return -1;
+}
+
+void ProcessInfo::signalSession(qint64 session, QList<int> signalList, bool leaderAlive, QByteArray marker)
+{
+#ifdef Q_OS_UNIX
+    if (session <= 0)
+        return;
+    QList<qint64> members;
+    for (auto entry : listProcesses()) {
+        if (entry.session != session)
+            continue;
+        if (!marker.isEmpty() && !readProcFile(QString("/proc/%1/environ").arg(entry.pid)).split('\0').contains(marker))
+            continue;
+        members << entry.pid;
+    }
+    for (auto signal : signalList) {
+        // the group also works where /proc is missing
+        if (leaderAlive)
+            ::kill(-session, signal);
+        for (auto p : members)
+            ::kill(p, signal);
+    }
+#else
+    Q_UNUSED(session);
+    Q_UNUSED(signalList);
+    Q_UNUSED(leaderAlive);
+    Q_UNUSED(marker);
+#endif
+}
@@ -0,0 +1,44 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef PROCINFO_H
+#define PROCINFO_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+
+// Process and memory information read from /proc, all functions
+// return -1 (or just the given pid) where it is not available.
+class ProcessInfo
+{
+  public:
+    static qint64 treeRss(qint64 pid);
+    static QMap<qint64, qint64> treeRss(const QList<qint64> &pids);
+    static qint64 availableMemory();
+    // Sends the signals in turn to every process still in the session,
+    // found with a single scan of /proc. The process group is only used
+    // while the leader is known to be an unreaped child of ours, a pid
+    // that was reaped may belong to a stranger by now. With a marker only
+    // processes carrying it in their environment are signalled.
+    static void signalSession(qint64 session, QList<int> signalList, bool leaderAlive = false,
+                              QByteArray marker = QByteArray());
+};
+
+#endif // PROCINFO_H
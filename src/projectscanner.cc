@@ -0,0 +1,163 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "projectscanner.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QRunnable>
+#include <QSet>
+#include <algorithm>
+
+class ListJob : public QRunnable
+{
+  public:
+    ListJob(ProjectScanner *scanner, QString path, DirListing cached, int generation)
+            : scanner(scanner), path(path), cached(cached), generation(generation)
+    {
+    }
+
+    void run() override
+    {
+        // adding or removing an entry touches the directory, edits inside do not
+        qint64 modified = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+        if (cached.modified == modified) {
+            Q_EMIT scanner->listed(generation, path, cached);
+            return;
+        }
+        QDir dir(path);
+        DirListing listing;
+        listing.modified = modified;
+        listing.workdir = ProjectScanner::isWorkdir(dir);
+        if (!listing.workdir) {
+            listing.files = dir.entryList(QStringList() << "*.sby", QDir::Files);
+            // symlinked directories could loop back up the tree
+            listing.dirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        }
+        Q_EMIT scanner->listed(generation, path, listing);
+    }
+
+  protected:
+    ProjectScanner *scanner;
+    QString path;
+    DirListing cached;
+    int generation;
+};
+
+ProjectScanner::ProjectScanner(QObject *parent) : QObject(parent), generation(0), pending(0)
+{
+    qRegisterMetaType<DirListing>();
+    pool = new QThreadPool(this);
+    connect(this, &ProjectScanner::listed, this, [=](int jobGeneration, QString path, DirListing listing) {
+        if (jobGeneration != generation)
+            return;
+        pending--;
+        listings[path] = listing;
+        for (auto name : listing.dirs) {
+            QString sub = path + "/" + name;
+            if (!name.startsWith(".") && !matches(exclude, name, root.relativeFilePath(sub)))
+                list(sub);
+        }
+        if (pending == 0)
+            collect();
+    }, Qt::QueuedConnection);
+}
+
+ProjectScanner::~ProjectScanner()
+{
+    pool->clear();
+    pool->waitForDone();
+}
+
+void ProjectScanner::setFilters(QStringList includePatterns, QStringList excludePatterns)
+{
+    include = includePatterns;
+    exclude = excludePatterns;
+}
+
+bool ProjectScanner::isWorkdir(QDir dir)
+{
+    // sby copies the config it ran with into every work directory
+    return QFileInfo(dir.filePath("config.sby")).isFile() && QFileInfo(dir.filePath("model")).isDir();
+}
+
+bool ProjectScanner::matches(const QStringList &patterns, QString name, QString relative)
+{
+    for (auto pattern : patterns) {
+        QRegExp rx(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+        if (rx.exactMatch(name) || rx.exactMatch(relative))
+            return true;
+    }
+    return false;
+}
+
+void ProjectScanner::scan(QDir folder)
+{
+    if (folder.absolutePath() != root.absolutePath())
+        listings.clear();
+    root = QDir(folder.absolutePath());
+    pool->clear();
+    generation++;
+    pending = 0;
+    list(root.absolutePath());
+}
+
+void ProjectScanner::list(QString path)
+{
+    pending++;
+    DirListing cached = listings.value(path, DirListing{-1, false, QStringList(), QStringList()});
+    pool->start(new ListJob(this, path, cached, generation));
+}
+
+void ProjectScanner::collect()
+{
+    // walk the listings from the top, directories no longer reachable are dropped
+    QStringList files;
+    QSet<QString> visited;
+    QStringList todo;
+    todo << root.absolutePath();
+    directories.clear();
+    while (!todo.isEmpty()) {
+        QString path = todo.takeFirst();
+        if (!listings.contains(path) || visited.contains(path))
+            continue;
+        visited.insert(path);
+        const DirListing &listing = listings[path];
+        if (listing.workdir)
+            continue;
+        directories << path;
+        for (auto name : listing.files) {
+            QString relative = root.relativeFilePath(path + "/" + name);
+            if ((include.isEmpty() || matches(include, name, relative)) && !matches(exclude, name, relative))
+                files << relative;
+        }
+        for (auto name : listing.dirs) {
+            QString sub = path + "/" + name;
+            if (!name.startsWith(".") && !matches(exclude, name, root.relativeFilePath(sub)))
+                todo << sub;
+        }
+    }
+    for (auto path : listings.keys())
+        if (!visited.contains(path))
+            listings.remove(path);
+    std::sort(files.begin(), files.end(), [](const QString &a, const QString &b) {
+        return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+    });
+    Q_EMIT finished(files);
+}
@@ -0,0 +1,81 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef PROJECTSCANNER_H
+#define PROJECTSCANNER_H
+
+#include <QDir>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+// What one directory holds, the modification time tells whether the
+// listing can be reused on the next scan
+struct DirListing
+{
+    qint64 modified;
+    bool workdir;
+    QStringList files;
+    QStringList dirs;
+};
+
+Q_DECLARE_METATYPE(DirListing)
+
+// Finds .sby files in a folder and all folders below it. Every directory
+// is listed by a job of its own on a thread pool, sby work directories are
+// skipped. Listings are kept between scans, so a rescan only lists the
+// directories that changed since.
+class ProjectScanner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit ProjectScanner(QObject *parent = 0);
+    virtual ~ProjectScanner();
+
+    // wildcards matched against the file or directory name and the path
+    // relative to the scanned folder
+    void setFilters(QStringList include, QStringList exclude);
+    void scan(QDir root);
+    bool isScanning() { return pending > 0; }
+    QStringList getDirectories() { return directories; }
+    static bool isWorkdir(QDir dir);
+
+  Q_SIGNALS:
+    // .sby files relative to the scanned folder
+    void finished(QStringList files);
+    void listed(int generation, QString path, DirListing listing);
+
+  protected:
+    void list(QString path);
+    void collect();
+    bool matches(const QStringList &patterns, QString name, QString relative);
+
+    QThreadPool *pool;
+    QDir root;
+    QStringList include;
+    QStringList exclude;
+    QHash<QString, DirListing> listings;
+    QStringList directories;
+    int generation;
+    int pending;
+};
+
+#endif // PROJECTSCANNER_H
@@ -1,52 +1,56 @@
 #ifndef QSBYITEM_H
 #define QSBYITEM_H
 
-#include <QGroupBox>
-#include <QVBoxLayout>
-#include <QProgressBar>
-#include <QAction>
+#include <QObject>
 #include <QProcess>
-#include <QLabel>
 #include "sbyitem.h"
+#include "taskrunner.h"
 
-class QSBYItem : public QGroupBox
+// Actions and signals of one file or task. There is one per task, each
+// about 1-2 KB with its connections, which is less than the expanded
+// config the task itself keeps. The tree never goes through these, the
+// model reads the SBYItem directly, so their number does not affect
+// scrolling or painting.
+class QSBYItem : public QObject
 {
     Q_OBJECT
 
   public:
-    QSBYItem(const QString & title, SBYItem *item, QSBYItem* top, QWidget *parent = 0);
+    QSBYItem(SBYItem *item, QSBYItem* top, QObject *parent = 0);
     virtual ~QSBYItem();
-    void runSBYTask();
+    void runSBYTask(QProcessEnvironment env, WorkerPool *pool = nullptr, QString runDirectory = QString());
+    bool attachSBYTask(QString runDirectory, const DetachedState &state);
     void refreshView();
     QString getName();
+    void play();
+    void edit();
+    void showLog();
+    void showFiles();
+    void showWave();
     void stopProcess();
+    void killProcess(QString status, QString message);
+    bool isRunning() { return runner != nullptr; }
+    qint64 processId() { return runner ? runner->processId() : 0; }
+    TaskRunner *getRunner() { return runner; }
     QSBYItem* getParent() { return top; }
-  protected Q_SLOTS:
-    void printOutput();
+    SBYItem* getItem() { return item; }
   Q_SIGNALS:
+    void changed();
+    void progress();
+    void sbyEvent(SBYEvent event);
     void appendLog(QString content);
-    void taskExecuted();
+    void taskExecuted(QString name);
     void startTask(QString name);
     void editOpen(QString path, QString fileName, bool reloadOnly);
     void previewOpen(QString content, QString fileName, QString taskName, bool reloadOnly);
-    void previewLog(QString content, QString fileName, QString taskName, bool reloadOnly);
+    void previewLog(QString name, bool reloadOnly);
     void previewSource(QString fileName, bool reloadOnly);
     void previewVCD(QString fileName);
   protected:    
-    QProgressBar *progressBar;
-    QAction *actionStatus;
-    QAction *actionPlay;
-    QAction *actionStop;
-    QAction *actionEdit;
-    QAction *actionLog;
-    QAction *actionFiles;
-    QAction *actionWave;
+    void createRunner(QString runDirectory);
 
     SBYItem *item;
-    QProcess *process;
-    bool shutdown;
-    QProcess::ProcessState state;
-    QLabel *label;
+    TaskRunner *runner;
     QSBYItem *top;
 };
 
@@ -0,0 +1,265 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "resultcache.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QMap>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+class StoreJob : public QRunnable
+{
+  public:
+    StoreJob(ResultCache *cache, QString fingerprint, QString workdir, int generation)
+            : cache(cache), fingerprint(fingerprint), workdir(workdir), generation(generation)
+    {
+    }
+
+    void run() override { cache->store(fingerprint, workdir, generation); }
+
+  protected:
+    ResultCache *cache;
+    QString fingerprint;
+    QString workdir;
+    int generation;
+};
+
+// status XML, logfile and any other top level file, plus the traces
+QStringList ResultCache::resultFiles(QString workdir)
+{
+    QDir src(workdir);
+    QStringList files;
+    for (auto info : src.entryInfoList(QDir::Files))
+        files << info.fileName();
+    for (auto engine : src.entryInfoList(QStringList() << "engine_*", QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QDir engineDir(engine.absoluteFilePath());
+        for (auto vcd : engineDir.entryInfoList(QStringList() << "*.vcd", QDir::Files))
+            files << engine.fileName() + "/" + vcd.fileName();
+    }
+    return files;
+}
+
+static qint64 copyResultFiles(QString from, QString to)
+{
+    QDir src(from);
+    QDir dst(to);
+    qint64 size = 0;
+    for (auto file : ResultCache::resultFiles(from)) {
+        dst.mkpath(QFileInfo(file).path());
+        QFile::copy(src.filePath(file), dst.filePath(file));
+        size += QFileInfo(src.filePath(file)).size();
+    }
+    return size;
+}
+
+static qint64 readNumber(QString fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return 0;
+    return f.readAll().trimmed().toLongLong();
+}
+
+static void writeNumber(QString fileName, qint64 value)
+{
+    QFile f(fileName);
+    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        f.write(QByteArray::number(value));
+}
+
+class RestoreJob : public QRunnable
+{
+  public:
+    RestoreJob(ResultCache *cache, QString fingerprint, QString workdir, int ticket)
+            : cache(cache), fingerprint(fingerprint), workdir(workdir), ticket(ticket)
+    {
+    }
+
+    void run() override { Q_EMIT cache->restored(ticket, cache->restore(fingerprint, workdir)); }
+
+  protected:
+    ResultCache *cache;
+    QString fingerprint;
+    QString workdir;
+    int ticket;
+};
+
+ResultCache &ResultCache::instance()
+{
+    static ResultCache cache;
+    return cache;
+}
+
+ResultCache::ResultCache() : limit(qint64(1024) << 20), hits(0), misses(0)
+{
+    // the first use may be on a pool thread, signals belong to the application
+    if (QCoreApplication::instance())
+        moveToThread(QCoreApplication::instance()->thread());
+    root = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results");
+    root.mkpath(".");
+    // one at a time, stores and evictions never see each other half done
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(1);
+}
+
+bool ResultCache::contains(QString fingerprint)
+{
+    return isEnabled() && !fingerprint.isEmpty() && QFileInfo(entryPath(fingerprint) + "/files").isDir();
+}
+
+bool ResultCache::restore(QString fingerprint, QString workdir)
+{
+    int generation;
+    {
+        // sby may be filling it already, status refreshes run on other threads
+        QMutexLocker locker(&mutex);
+        if (claimed.contains(workdir))
+            return false;
+        generation = claims.value(workdir);
+    }
+    if (!contains(fingerprint)) {
+        count(false);
+        return false;
+    }
+    // next to the work directory, so moving it into place is a rename
+    QString suffix = QString::number(quintptr(QThread::currentThreadId()));
+    QString tmp = workdir + ".restore" + suffix;
+    QString old = workdir + ".replaced" + suffix;
+    QDir(tmp).removeRecursively();
+    QDir(old).removeRecursively();
+    copyResultFiles(entryPath(fingerprint) + "/files", tmp);
+    bool restored = false;
+    {
+        // a run claimed it or the entry got evicted while it was copied
+        QMutexLocker locker(&mutex);
+        if (!claimed.contains(workdir) && claims.value(workdir) == generation && contains(fingerprint)) {
+            QDir dir;
+            if (!dir.exists(workdir) || dir.rename(workdir, old))
+                restored = dir.rename(tmp, workdir);
+        }
+    }
+    QDir(tmp).removeRecursively();
+    QDir(old).removeRecursively();
+    if (restored)
+        touch(entryPath(fingerprint));
+    count(restored);
+    return restored;
+}
+
+int ResultCache::restoreLater(QString fingerprint, QString workdir)
+{
+    int ticket = tickets.fetchAndAddRelaxed(1) + 1;
+    // not behind the stores, a run waits for the answer
+    QThreadPool::globalInstance()->start(new RestoreJob(this, fingerprint, workdir, ticket));
+    return ticket;
+}
+
+void ResultCache::count(bool hit)
+{
+    int hitCount, missCount;
+    {
+        QMutexLocker locker(&mutex);
+        (hit ? hits : misses)++;
+        hitCount = hits;
+        missCount = misses;
+    }
+    Q_EMIT countersChanged(hitCount, missCount);
+}
+
+void ResultCache::storeLater(QString fingerprint, QString workdir)
+{
+    if (!isEnabled() || fingerprint.isEmpty())
+        return;
+    int generation;
+    {
+        QMutexLocker locker(&mutex);
+        generation = claims.value(workdir);
+    }
+    pool->start(new StoreJob(this, fingerprint, workdir, generation));
+}
+
+void ResultCache::store(QString fingerprint, QString workdir, int generation)
+{
+    QString entry = entryPath(fingerprint);
+    if (QFileInfo(entry).exists()) {
+        touch(entry);
+        return;
+    }
+    // fill a private directory first, other instances only ever see complete entries
+    QString tmp = entry + ".tmp" + QString::number(QCoreApplication::applicationPid());
+    QDir(tmp).removeRecursively();
+    qint64 size = copyResultFiles(workdir, tmp + "/files");
+    writeNumber(tmp + "/size", size);
+    writeNumber(tmp + "/access", QDateTime::currentMSecsSinceEpoch());
+    bool stored;
+    {
+        // a rerun may have replaced the directory while it was copied
+        QMutexLocker locker(&mutex);
+        stored = !claimed.contains(workdir) && claims.value(workdir) == generation && root.rename(tmp, entry);
+    }
+    if (!stored)
+        QDir(tmp).removeRecursively();
+    evict();
+}
+
+void ResultCache::claim(QString workdir)
+{
+    QMutexLocker locker(&mutex);
+    claimed.insert(workdir);
+    claims[workdir]++;
+}
+
+void ResultCache::release(QString workdir)
+{
+    QMutexLocker locker(&mutex);
+    claimed.remove(workdir);
+}
+
+void ResultCache::touch(QString entry)
+{
+    writeNumber(entry + "/access", QDateTime::currentMSecsSinceEpoch());
+}
+
+void ResultCache::evict()
+{
+    QList<QPair<qint64, QString>> entries;
+    QMap<QString, qint64> sizes;
+    qint64 total = 0;
+    for (auto info : root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        if (info.fileName().contains(".tmp"))
+            continue;
+        QString path = info.absoluteFilePath();
+        sizes[path] = readNumber(path + "/size");
+        total += sizes[path];
+        entries << qMakePair(readNumber(path + "/access"), path);
+    }
+    std::sort(entries.begin(), entries.end());
+    for (auto entry : entries) {
+        if (total <= limit)
+            break;
+        QDir(entry.second).removeRecursively();
+        total -= sizes[entry.second];
+    }
+}
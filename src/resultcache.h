@@ -0,0 +1,89 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QAtomicInt>
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+// Finished task results stored by fingerprint, shared by every workspace
+// of the user. Entries are evicted least recently used first once the
+// total size goes over the limit. Results are stored on a thread of the
+// cache's own and restored next to the work directory before they are
+// moved into place, the lock is only held to check and mark claims.
+class ResultCache : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static ResultCache &instance();
+    static QStringList resultFiles(QString workdir);
+
+    void setLimit(qint64 bytes) { limit = bytes; }
+    bool isEnabled() { return limit > 0; }
+    bool contains(QString fingerprint);
+    // copies on the calling thread, never on the GUI thread
+    bool restore(QString fingerprint, QString workdir);
+    // on a pool thread, answered through restored() with the returned ticket
+    int restoreLater(QString fingerprint, QString workdir);
+    // dropped when a run claims the directory before the copy is complete
+    void storeLater(QString fingerprint, QString workdir);
+    // work directories of running tasks, restore() leaves them alone and
+    // drops a copy into one that got claimed while it was under way
+    void claim(QString workdir);
+    void release(QString workdir);
+    // stores still pending, before the application quits
+    void waitForDone() { pool->waitForDone(); }
+
+  Q_SIGNALS:
+    void restored(int ticket, bool restored);
+    // from whichever thread restored, connect queued
+    void countersChanged(int hits, int misses);
+
+  protected:
+    friend class StoreJob;
+
+    ResultCache();
+    QString entryPath(QString fingerprint) { return root.filePath(fingerprint); }
+    void store(QString fingerprint, QString workdir, int generation);
+    void count(bool hit);
+    void touch(QString entry);
+    void evict();
+
+    QDir root;
+    qint64 limit;
+    int hits;
+    int misses;
+    QThreadPool *pool;
+    QMutex mutex;
+    QSet<QString> claimed;
+    // how often each directory was claimed, a copy only completes if unchanged
+    QHash<QString, int> claims;
+    QAtomicInt tickets;
+};
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,80 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "runjournal.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+static const int journalVersion = 1;
+
+static QString journalFile(QDir folder) { return QDir(RunJournal::directory(folder)).filePath("journal.json"); }
+
+void RunJournal::load(QDir folder)
+{
+    running.clear();
+    queued.clear();
+    QFile f(journalFile(folder));
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    if (root["version"].toInt() != journalVersion)
+        return;
+    QJsonObject runs = root["running"].toObject();
+    for (auto it = runs.begin(); it != runs.end(); ++it) {
+        QJsonObject entry = it.value().toObject();
+        DetachedState state;
+        state.pid = qint64(entry["pid"].toDouble());
+        state.offset = qint64(entry["offset"].toDouble());
+        state.startedAt = qint64(entry["started"].toDouble());
+        state.fingerprint = entry["fingerprint"].toString();
+        running[it.key()] = state;
+    }
+    for (auto name : root["queued"].toArray())
+        queued << name.toString();
+}
+
+void RunJournal::save(QDir folder)
+{
+    if (running.isEmpty() && queued.isEmpty()) {
+        QFile::remove(journalFile(folder));
+        return;
+    }
+    QJsonObject runs;
+    for (auto it = running.begin(); it != running.end(); ++it) {
+        QJsonObject entry;
+        entry["pid"] = double(it.value().pid);
+        entry["offset"] = double(it.value().offset);
+        entry["started"] = double(it.value().startedAt);
+        entry["fingerprint"] = it.value().fingerprint;
+        runs[it.key()] = entry;
+    }
+    QJsonObject root;
+    root["version"] = journalVersion;
+    root["running"] = runs;
+    root["queued"] = QJsonArray::fromStringList(queued);
+    folder.mkpath(directory(folder));
+    QSaveFile f(journalFile(folder));
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    f.commit();
+}
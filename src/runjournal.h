@@ -0,0 +1,45 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef RUNJOURNAL_H
+#define RUNJOURNAL_H
+
+#include <QDir>
+#include <QMap>
+#include <QStringList>
+#include "detachedrun.h"
+
+// Tasks running detached from the GUI and the queue behind them, so the
+// next GUI opened on the folder carries on where this one stopped. Kept
+// as JSON in a hidden directory next to the logs of the runs.
+class RunJournal
+{
+  public:
+    static QString directory(QDir folder) { return folder.filePath(".sby-gui-runs"); }
+
+    void load(QDir folder);
+    // an empty journal removes the file
+    void save(QDir folder);
+
+    // by task name, in the same form as the queue uses
+    QMap<QString, DetachedState> running;
+    QStringList queued;
+};
+
+#endif // RUNJOURNAL_H
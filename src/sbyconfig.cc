@@ -0,0 +1,265 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "sbyconfig.h"
+#include <QFile>
+#include <QProcess>
+#include <QRegExp>
+#include <QSet>
+
+// sby only takes plain names literally, anything else is a regular expression
+static bool isPlainName(QString name)
+{
+    for (auto c : QString("(?*.[]|)"))
+        if (name.contains(c))
+            return false;
+    return true;
+}
+
+SBYConfig::SBYConfig() : supported(false) {}
+
+bool SBYConfig::read(QString fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return unsupported("unable to read " + fileName);
+    setContents(QString::fromUtf8(f.readAll()));
+    return supported;
+}
+
+void SBYConfig::setContents(QString contents)
+{
+    // same as Python reading the file in text mode
+    lines = contents.split(QRegExp("\r\n|\r|\n"));
+    if (contents.isEmpty() || contents.endsWith('\n') || contents.endsWith('\r'))
+        lines.removeLast();
+    supported = true;
+    reason.clear();
+    tasks.clear();
+    QStringList config;
+    process(QString(), config);
+}
+
+bool SBYConfig::unsupported(QString why)
+{
+    if (reason.isEmpty())
+        reason = why;
+    supported = false;
+    return false;
+}
+
+QString SBYConfig::expand(QString task)
+{
+    QStringList config;
+    if (!supported || !process(task, config))
+        return QString();
+    return config.join('\n') + "\n";
+}
+
+// value of an [options] entry in an expanded config, empty when not set
+QString SBYConfig::option(QString config, QString name)
+{
+    bool options = false;
+    QString value;
+    for (auto line : config.split(QRegExp("\r\n|\r|\n"))) {
+        if (line.startsWith("[")) {
+            options = line.trimmed() == "[options]";
+            continue;
+        }
+        QStringList tokens = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if (options && tokens.size() >= 2 && tokens[0] == name)
+            value = tokens[1];
+    }
+    return value;
+}
+
+bool SBYConfig::process(QString task, QStringList &config)
+{
+    // follows read_sbyconfig() in sby, task is empty for the whole file
+    bool tasksSection = false;
+    bool skipBlock = false;
+    bool skippingBlocks = false;
+    bool matched = false;
+    QSet<QString> tagsActive;
+    QSet<QString> tagsAll;
+    QStringList taskList;
+
+    for (QString line : lines) {
+        if (line == "--pycode-begin--")
+            return unsupported("uses pycode");
+
+        if (tasksSection && line.startsWith("["))
+            tasksSection = false;
+
+        if (skippingBlocks && line == "--") {
+            skipBlock = false;
+            skippingBlocks = false;
+            continue;
+        }
+
+        if (!tasksSection) {
+            bool foundTag = false;
+            bool skipLine = false;
+            for (auto tag : tagsAll) {
+                bool match;
+                if (line.startsWith(tag + ":")) {
+                    line = line.mid(tag.size() + 1).replace(QRegExp("^\\s+"), "");
+                    match = tagsActive.contains(tag);
+                } else if (line.startsWith("~" + tag + ":")) {
+                    line = line.mid(tag.size() + 2).replace(QRegExp("^\\s+"), "");
+                    match = !tagsActive.contains(tag);
+                } else {
+                    continue;
+                }
+                if (line.isEmpty()) {
+                    skippingBlocks = true;
+                    skipBlock = !match;
+                    skipLine = true;
+                } else {
+                    skipLine = !match;
+                }
+                foundTag = true;
+                break;
+            }
+            if (!tagsAll.isEmpty() && !foundTag) {
+                QStringList tokens = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+                if (!tokens.isEmpty() && tokens[0][0] == line[0] && tokens[0].endsWith(':'))
+                    return unsupported("invalid task specifier " + tokens[0]);
+            }
+            if (skipLine || skipBlock)
+                continue;
+        }
+
+        if (tasksSection) {
+            if (task.isEmpty())
+                config << line;
+            if (line.startsWith("#"))
+                continue;
+            QStringList parts = line.split(':');
+            QStringList lhs, rhs;
+            if (parts.size() == 1) {
+                QStringList tokens = parts[0].split(QRegExp("\\s+"), QString::SkipEmptyParts);
+                if (tokens.isEmpty())
+                    continue;
+                lhs = tokens.mid(0, 1);
+                rhs = tokens.mid(1);
+            } else if (parts.size() == 2) {
+                lhs = parts[0].split(QRegExp("\\s+"), QString::SkipEmptyParts);
+                rhs = parts[1].split(QRegExp("\\s+"), QString::SkipEmptyParts);
+            } else {
+                return unsupported("syntax error in tasks block");
+            }
+            // sby activates every tag a pattern fully matches, only plain tags are taken as they are
+            for (auto tag : rhs) {
+                if (!isPlainName(tag))
+                    return unsupported("regular expression " + tag + " in tasks block");
+                if (tag != "default")
+                    tagsAll.insert(tag);
+            }
+            for (auto name : lhs) {
+                if (!isPlainName(name))
+                    return unsupported("regular expression " + name + " in tasks block");
+                if (!taskList.contains(name))
+                    taskList << name;
+                tagsAll.insert(name);
+                if (name == task) {
+                    matched = true;
+                    tagsActive.insert(name);
+                    for (auto tag : rhs)
+                        tagsActive.insert(tag);
+                }
+            }
+            continue;
+        }
+
+        if (line == "[tasks]") {
+            if (task.isEmpty())
+                config << line;
+            tasksSection = true;
+            continue;
+        }
+
+        config << line;
+    }
+
+    if (task.isEmpty())
+        tasks = taskList;
+    else if (!matched)
+        return unsupported("task " + task + " not found");
+    return true;
+}
+
+QString SBYConfig::runSby(QFileInfo path, QStringList args)
+{
+    QProcess process;
+    process.setProgram("sby");
+    process.setArguments(args);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("PYTHONUNBUFFERED", "1");
+    process.setProcessEnvironment(env);
+    process.setWorkingDirectory(path.dir().canonicalPath());
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start();
+    process.waitForFinished();
+    return process.readAllStandardOutput();
+}
+
+bool SBYConfig::compareWithSby(QFileInfo path, QTextStream &out)
+{
+    SBYConfig config;
+    if (!config.read(path.absoluteFilePath())) {
+        out << "SKIP " << path.filePath() << ": " << config.getReason() << endl;
+        return true;
+    }
+    QStringList tasks = runSby(path, QStringList() << "--dumptasks" << path.fileName())
+                                .split(QRegExp("[\r\n]"), QString::SkipEmptyParts);
+    if (tasks != config.getTasks()) {
+        out << "FAIL " << path.filePath() << ": tasks " << config.getTasks().join(' ') << ", sby says "
+            << tasks.join(' ') << endl;
+        return false;
+    }
+    if (tasks.isEmpty())
+        tasks << "";
+    bool ok = true;
+    for (auto task : tasks) {
+        QStringList args;
+        args << "--dumpcfg" << path.fileName();
+        if (!task.isEmpty())
+            args << task;
+        QString expected = runSby(path, args);
+        QString actual = config.expand(task);
+        if (!config.isSupported()) {
+            out << "SKIP " << path.filePath() << " " << task << ": " << config.getReason() << endl;
+            return ok;
+        }
+        if (actual == expected)
+            continue;
+        QStringList expectedLines = expected.split('\n');
+        QStringList actualLines = actual.split('\n');
+        int line = 0;
+        while (line < expectedLines.size() && line < actualLines.size() && expectedLines[line] == actualLines[line])
+            line++;
+        out << "FAIL " << path.filePath() << " " << task << ": line " << line + 1 << " is \""
+            << actualLines.value(line) << "\", sby has \"" << expectedLines.value(line) << "\"" << endl;
+        ok = false;
+    }
+    if (ok)
+        out << "OK   " << path.filePath() << " (" << config.getTasks().size() << " tasks)" << endl;
+    return ok;
+}
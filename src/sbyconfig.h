@@ -0,0 +1,59 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SBYCONFIG_H
+#define SBYCONFIG_H
+
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+// In-process reading of .sby files, giving the same task list and per
+// task config as sby --dumptasks and sby --dumpcfg without starting
+// Python. Files using something it does not handle (pycode, regular
+// expressions in [tasks], syntax errors sby would report) are flagged as
+// unsupported, the caller then has to ask sby itself.
+class SBYConfig
+{
+  public:
+    SBYConfig();
+
+    bool read(QString fileName);
+    void setContents(QString contents);
+    bool isSupported() { return supported; }
+    QString getReason() { return reason; }
+    QStringList getTasks() { return tasks; }
+    QString expand(QString task);
+    static QString option(QString config, QString name);
+
+    static QString runSby(QFileInfo path, QStringList args);
+    static bool compareWithSby(QFileInfo path, QTextStream &out);
+
+  protected:
+    bool process(QString task, QStringList &config);
+    bool unsupported(QString why);
+
+    QStringList lines;
+    QStringList tasks;
+    bool supported;
+    QString reason;
+};
+
+#endif // SBYCONFIG_H
@@ -1,115 +1,213 @@
 #include "sbyitem.h"
-#include <QDomDocument>
+#include "fingerprint.h"
+#include "resultcache.h"
+#include "sbyconfig.h"
 #include <QFile>
 #include <QProcess>
 #include <QDir>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QXmlStreamWriter>
+#include <algorithm>
 
-SBYItem::SBYItem(QFileInfo path, QString name) : path(path), name(name), timeSpent(-1), previousLog()
+SBYItem::SBYItem(QFileInfo path, QString name) : path(path), name(name), timeSpent(-1), logOffset(-1), fingerprintState(FingerprintUnknown)
 {
 
 }
 
-void SBYItem::updateFromXML(QFileInfo inputFile)
-{    
-    QFileInfo xmlFile(inputFile.path() + "/" + inputFile.completeBaseName() + ".xml");
-    timeSpent = -1;
-    previousLog = "";
-    int errors = 0;
-    int failures = 0;
-    statusColor = 0;
-    if (xmlFile.exists()) {
-        QDomDocument xml;
-        QFile f(xmlFile.absoluteFilePath());
-        f.open(QIODevice::ReadOnly);
-        xml.setContent(&f);
-        f.close();
-        QDomNodeList testsuiteList = xml.elementsByTagName("testsuite");
-        if (!testsuiteList.isEmpty()) {
-            QDomElement testsuite = testsuiteList.at(0).toElement();
-            if (testsuite.hasAttribute("errors"))
-            {
-                errors = testsuite.attribute("errors").toInt();
-            }
-            if (testsuite.hasAttribute("failures"))
-            {
-                failures = testsuite.attribute("failures").toInt();
-            }
-        }
-        QDomNodeList testcaseList = xml.elementsByTagName("testcase");
-        if (!testcaseList.isEmpty()) {
-            QDomElement testcase = testcaseList.at(0).toElement();
-            if (testcase.hasAttribute("time"))
-            {
-                timeSpent = testcase.attribute("time").toInt();
-            }
-            if (testcase.hasAttribute("status"))
-            {
-                percentage = 100;                
-                status = testcase.attribute("status");
-                if (errors==0 && failures==0) {
-                    statusColor = 1;                     
-                }
-                else {
-                    statusColor = 2; 
-                }
-            }
-        }
-        QDomNodeList systemOutList = xml.elementsByTagName("system-out");
-        if (!systemOutList.isEmpty()) {
-            QDomElement systemOut = systemOutList.at(0).toElement();
-            previousLog = systemOut.text();
-        }
-    } 
+QString SBYItem::getResultFile()
+{
+    QDir dir(getWorkDir());
+    return dir.filePath(dir.dirName() + ".xml");
+}
+
+QString SBYItem::computeFingerprint()
+{
+    return Fingerprint::compute(getContents(), getFiles(), QDir(getWorkFolder()));
+}
+
+void SBYItem::storeFingerprint(QString fingerprint)
+{
+    // only a finished run has a result the fingerprint can belong to
+    if (!QFileInfo(getResultFile()).exists())
+        return;
+    QFile f(QDir(getWorkDir()).filePath(Fingerprint::fileName()));
+    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        f.write(fingerprint.toLatin1() + "\n");
+}
+
+void SBYItem::setState(QString newStatus, int color, int percent, int time)
+{
+    status = newStatus;
+    statusColor = color;
+    percentage = percent;
+    timeSpent = time;
+}
+
+void SBYItem::copyStatus(SBYItem &other)
+{
+    status = other.status;
+    statusColor = other.statusColor;
+    percentage = other.percentage;
+    timeSpent = other.timeSpent;
+    logFile = other.logFile;
+    logOffset = other.logOffset;
+    fingerprintState = other.fingerprintState;
+    properties = other.properties;
+    getVCDFiles() = other.getVCDFiles();
+}
+
+SBYStatusRequest SBYItem::statusRequest()
+{
+    return SBYStatusRequest{getWorkDir(), getContents(), getFiles(), getWorkFolder()};
+}
+
+// only uses the request, safe to call from any thread
+SBYStatus SBYItem::collectStatus(SBYStatusRequest request)
+{
+    ResultCache &cache = ResultCache::instance();
+    QString fingerprint;
+    if (!QFileInfo(request.workDir).isDir() && cache.isEnabled()) {
+        fingerprint = Fingerprint::compute(request.config, request.files, QDir(request.base));
+        if (cache.contains(fingerprint))
+            cache.restore(fingerprint, request.workDir);
+    }
+    SBYStatus status = StatusCache::instance().read(request.workDir);
+    if (!status.storedFingerprint.isEmpty()) {
+        if (fingerprint.isEmpty())
+            fingerprint = Fingerprint::compute(request.config, request.files, QDir(request.base));
+        status.fingerprintState = (status.storedFingerprint == fingerprint) ? FingerprintUpToDate : FingerprintStale;
+    }
+    return status;
+}
+
+bool SBYItem::setStatus(const SBYStatus &newStatus)
+{
+    bool changed = status != newStatus.status || statusColor != newStatus.statusColor ||
+                   percentage != newStatus.percentage || timeSpent != newStatus.timeSpent ||
+                   logFile != newStatus.logFile || logOffset != newStatus.logOffset || fingerprintState != newStatus.fingerprintState ||
+                   getVCDFiles() != newStatus.vcdFiles || properties != newStatus.properties;
+    status = newStatus.status;
+    statusColor = newStatus.statusColor;
+    percentage = newStatus.percentage;
+    timeSpent = newStatus.timeSpent;
+    logFile = newStatus.logFile;
+    logOffset = newStatus.logOffset;
+    fingerprintState = newStatus.fingerprintState;
+    getVCDFiles() = newStatus.vcdFiles;
+    properties = newStatus.properties;
+    return changed;
+}
+
+// anything sby did not decide yet counts as unknown
+int SBYItem::countProperties(QString state)
+{
+    int count = 0;
+    for (auto &property : properties) {
+        bool decided = property.status == "PASS" || property.status == "FAIL";
+        if (property.status == state || (state == "UNKNOWN" && !decided))
+            count++;
+    }
+    return count;
+}
+
+void SBYItem::writeStatusXML(QString status, QString message, int time)
+{
+    // same layout as the JUnit file written by sby, so StatusCache picks it up
+    QDir dir(getWorkDir());
+    dir.mkpath(".");
+    QFile f(getResultFile());
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+    QString taskName = isTop() ? "default" : getTaskName();
+    QXmlStreamWriter xml(&f);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("testsuites");
+    xml.writeStartElement("testsuite");
+    xml.writeAttribute("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+    xml.writeAttribute("hostname", QSysInfo::machineHostName());
+    xml.writeAttribute("package", path.completeBaseName());
+    xml.writeAttribute("id", "0");
+    xml.writeAttribute("name", taskName);
+    xml.writeAttribute("tests", "1");
+    xml.writeAttribute("errors", "1");
+    xml.writeAttribute("failures", "0");
+    xml.writeAttribute("time", QString::number(time));
+    xml.writeAttribute("skipped", "0");
+    xml.writeStartElement("testcase");
+    xml.writeAttribute("classname", path.completeBaseName());
+    xml.writeAttribute("name", taskName);
+    xml.writeAttribute("id", "0");
+    xml.writeAttribute("time", QString::number(time));
+    xml.writeAttribute("status", status);
+    xml.writeStartElement("error");
+    xml.writeAttribute("type", status);
+    xml.writeAttribute("message", message);
+    xml.writeEndElement();
+    xml.writeEndElement();
+    xml.writeTextElement("system-out", message + "\n");
+    xml.writeEndElement();
+    xml.writeEndElement();
+    xml.writeEndDocument();
 }
 
 SBYTask::SBYTask(QFileInfo path, QString name, QString content, QStringList files, SBYFile* parent) : SBYItem(path, name), content(content), parent(parent), files(files)
 {
 }
 
+QString SBYTask::getRelativeName() { return parent->getRelativeName(); }
+
 void SBYTask::updateTask()
-{    
-    statusColor = 0;
-    percentage = 0;
-    vcdFiles.clear();
-    QFileInfo dir(path.path() + "/" + path.completeBaseName() + "_" + name);
-    if (dir.exists() && dir.isDir()) {
-        QFileInfo indir(path.path() + "/" + path.completeBaseName() + "_" + name  + "/" + path.completeBaseName() + "_" + name);
-        updateFromXML(indir);
-        QFileInfo engine_0 = QFileInfo(indir.path() + "/" +  "engine_0");
-        if (engine_0.exists() && engine_0.isDir()) {
-            QDir vcdDir = QDir(engine_0.absoluteFilePath());
-            vcdDir.setNameFilters(QStringList()<<"*.vcd");            
-            vcdFiles = vcdDir.entryInfoList();
-        }
-    }
+{
+    setStatus(collectStatus(statusRequest()));
 }
 
+// only the own work directory changes when a task runs
 void SBYTask::update()
 {
-    parent->update();    
+    updateTask();
+    parent->updateSummary();
+}
+
+SBYFile::SBYFile(QFileInfo path) : SBYItem(path, path.fileName()), relativeName(path.fileName()), parsedSize(-1), parsedModified(-1)
+{
 }
 
-SBYFile::SBYFile(QFileInfo path) : SBYItem(path, path.fileName())
+void SBYFile::setParsedKey(qint64 size, qint64 modified, QByteArray hash)
 {
+    parsedSize = size;
+    parsedModified = modified;
+    parsedHash = hash;
+}
+
+void SBYFile::setParsed(QStringList newTaskList, QMap<QString, QString> newConfigs, QMap<QString, QStringList> newFiles)
+{
+    taskList = newTaskList;
+    configs = newConfigs;
+    tasks.clear();
+    tasksSet.clear();
+    for (auto task : taskList)
+    {
+        tasks.push_back(std::make_unique<SBYTask>(path, task, configs[task], newFiles[task], this));
+        tasksSet.insert(task);
+    }
+    files = haveTasks() ? QStringList() : newFiles[""];
+}
+
+void SBYFile::takeStatus(SBYFile &other)
+{
+    copyStatus(other);
+    for (auto &task : tasks) {
+        SBYTask *otherTask = other.getTask(task->getTaskName());
+        if (otherTask)
+            task->copyStatus(*otherTask);
+    }
 }
 
 QString SBYFile::dumpcfg(QFileInfo &path, QString task)
 {
-    QProcess process;        
-    QStringList args;
-    args << "--dumpcfg";
-    args << path.fileName();
-    args << task;
-    process.setProgram("sby");
-    process.setArguments(args);
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    env.insert("PYTHONUNBUFFERED","1");
-    process.setProcessEnvironment(env);    
-    process.setWorkingDirectory(path.dir().canonicalPath());
-    process.setProcessChannelMode(QProcess::MergedChannels);       
-    process.start();   
-    process.waitForFinished();
-    return process.readAllStandardOutput();
+    return SBYConfig::runSby(path, QStringList() << "--dumpcfg" << path.fileName() << task);
 }
 
 bool SBYFile::parse(QFileInfo &path)
@@ -117,21 +215,25 @@ bool SBYFile::parse(QFileInfo &path)
     try {
         taskList.clear();
         configs.clear();
+        QFileInfo info(path.absoluteFilePath());
+        setParsedKey(info.size(), info.lastModified().toMSecsSinceEpoch(), Fingerprint::fileHash(info.absoluteFilePath()));
+
+        // no Python startup per task unless the file needs sby itself
+        SBYConfig config;
+        if (config.read(path.absoluteFilePath())) {
+            for (auto task : config.getTasks()) {
+                configs.insert(task, config.expand(task));
+                taskList << task;
+            }
+            if (taskList.isEmpty())
+                configs.insert("", config.expand(""));
+            if (config.isSupported())
+                return true;
+            taskList.clear();
+            configs.clear();
+        }
 
-        QProcess process;        
-        QStringList args;
-        args << "--dumptasks";
-        args << path.fileName();
-        process.setProgram("sby");
-        process.setArguments(args);
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        env.insert("PYTHONUNBUFFERED","1");
-        process.setProcessEnvironment(env);
-        process.setWorkingDirectory(path.dir().canonicalPath());
-        process.setProcessChannelMode(QProcess::MergedChannels);       
-        process.start();   
-        process.waitForFinished();
-        QString output(process.readAllStandardOutput());
+        QString output = SBYConfig::runSby(path, QStringList() << "--dumptasks" << path.fileName());
         QStringList tasks = output.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
 
         for (auto task : tasks) {
@@ -180,43 +282,51 @@ void SBYFile::parse()
     }
 }
 
-void SBYFile::refresh()
+SBYFileDiff SBYFile::diff(SBYFile &parsed)
 {
-    std::unique_ptr<SBYFile> f = std::make_unique<SBYFile>(path);
-    f->parse();
-    f->update();
-
-    QSet<QString> newTaskSet = f->getTasksSet(); 
-    QSet<QString> currTaskSet = getTasksSet(); 
-    QSet<QString> newTasks = newTaskSet - currTaskSet;
-    QSet<QString> deletedTasks = currTaskSet - newTaskSet;
-
-    parse(path);
-    if (!haveTasks()) {
-        files = get_config_files("");
+    SBYFileDiff diff;
+    for (auto name : taskList)
+        if (!parsed.tasksSet.contains(name))
+            diff.removed << name;
+    for (auto name : parsed.taskList) {
+        if (!tasksSet.contains(name))
+            diff.added << name;
+        else if (configs.value(name) != parsed.configs.value(name) || getTask(name)->getFiles() != parsed.getTask(name)->getFiles())
+            diff.changed << name;
     }
+    if (!haveTasks() && !parsed.haveTasks() && (configs.value("") != parsed.configs.value("") || files != parsed.files))
+        diff.changed << "";
+    return diff;
+}
 
-    if(!newTasks.isEmpty())
-    {
-        for(auto name : newTasks) {
-            tasks.push_back(std::make_unique<SBYTask>(path,name, configs[name], get_config_files(name), this));
-            tasksSet.insert(name);
-        }
-    }
-    if(!deletedTasks.isEmpty())
-    {
-        for(auto name : deletedTasks) {
-            auto it = tasks.begin();
-            while(it != tasks.end()) {
-                if (it->get()->getTaskName() == name) {
-                    tasks.erase(it);
-                }
-                else ++it;
-            }            
-            tasksSet.remove(name);
+// take over the parsed tasks, existing task objects are kept so running
+// tasks and their widgets stay valid. The status comes along from the
+// parsed file, which was already updated on the loader thread.
+void SBYFile::merge(SBYFile &parsed)
+{
+    std::vector<std::unique_ptr<SBYTask>> merged;
+    for (auto &task : parsed.tasks) {
+        auto it = std::find_if(tasks.begin(), tasks.end(), [&](const std::unique_ptr<SBYTask> &t) {
+            return t->getTaskName() == task->getTaskName();
+        });
+        if (it != tasks.end()) {
+            (*it)->setContents(task->getContents(), task->getFiles());
+            merged.push_back(std::move(*it));
+        } else {
+            merged.push_back(std::make_unique<SBYTask>(path, task->getTaskName(), task->getContents(), task->getFiles(), this));
         }
+        merged.back()->copyStatus(*task);
     }
-    update();
+    tasks = std::move(merged);
+    taskList = parsed.taskList;
+    configs = parsed.configs;
+    tasksSet = parsed.tasksSet;
+    files = parsed.files;
+    setParsedKey(parsed.parsedSize, parsed.parsedModified, parsed.parsedHash);
+    if (haveTasks())
+        updateSummary();
+    else
+        copyStatus(parsed);
 }
 
 bool SBYFile::haveTasks()
@@ -226,43 +336,37 @@ bool SBYFile::haveTasks()
 
 void SBYFile::update()
 {
-    statusColor = 0;
-    percentage = 0;
-    vcdFiles.clear();
     if (!haveTasks()) {
-        QFileInfo dir(path.path() + "/" + path.completeBaseName());
-        if (dir.exists() && dir.isDir()) {
-            QFileInfo indir(path.path() + "/" + path.completeBaseName() + "/" + path.completeBaseName());
-            updateFromXML(indir);
-            QFileInfo engine_0 = QFileInfo(indir.path() + "/" +  "engine_0");
-            if (engine_0.exists() && engine_0.isDir()) {
-                QDir vcdDir = QDir(engine_0.absoluteFilePath());
-                vcdDir.setNameFilters(QStringList()<<"*.vcd");            
-                vcdFiles = vcdDir.entryInfoList();
-            }            
-        }        
+        setStatus(collectStatus(statusRequest()));
+        return;
     }
-    else // have tasks
-    {
-        int counter = 0;
-        int valid = 0;
-        for (auto& task : tasks)
-        {
-            task->updateTask();
-            if (task->getStatusColor()!=0) counter++;
-            if (task->getStatusColor()==1) valid++;
-        }
-        percentage = counter * 100 / tasks.size();
-        if (tasks.size()==counter) {
-            if (valid==counter) 
-                statusColor = 1;
-            else if (valid == 0)
-                statusColor = 2;
-            else
-                statusColor = 0;
-        } else {
+    for (auto &task : tasks)
+        task->updateTask();
+    updateSummary();
+}
+
+// a file with tasks only shows how far its tasks got
+void SBYFile::updateSummary()
+{
+    status = "";
+    fingerprintState = FingerprintUnknown;
+    vcdFiles.clear();
+    int counter = 0;
+    int valid = 0;
+    for (auto &task : tasks) {
+        if (task->getStatusColor() != 0) counter++;
+        if (task->getStatusColor() == 1) valid++;
+    }
+    percentage = tasks.empty() ? 0 : counter * 100 / tasks.size();
+    if (tasks.size() == counter) {
+        if (valid == counter)
+            statusColor = 1;
+        else if (valid == 0)
+            statusColor = 2;
+        else
             statusColor = 0;
-        }
+    } else {
+        statusColor = 0;
     }
 }
 
@@ -7,9 +7,22 @@
 #include <QDir>
 #include <QMap>
 #include <memory>
+#include "outputparser.h"
+#include "statuscache.h"
+
+// Copy of what collecting the status of an item needs, so it can be done
+// on another thread while the item itself changes
+struct SBYStatusRequest {
+    QString workDir;
+    QString config;
+    QStringList files;
+    QString base;
+};
 
 class SBYItem {
 public:
+    enum FingerprintState { FingerprintUnknown, FingerprintUpToDate, FingerprintStale };
+
     SBYItem(QFileInfo path, QString name);
     virtual ~SBYItem() { }
     QString getName() { return name; }
@@ -20,12 +33,32 @@ public:
     QString getStatus() { return status; }
     int getPercentage() { return percentage; }
     int &getTimeSpent() { return timeSpent; }
-    QString &getPreviousLog() { return previousLog; }
+    // the log is only read from the result file when it is shown
+    bool hasPreviousLog() { return logOffset >= 0; }
+    QString getPreviousLog() { return StatusCache::readLog(logFile, logOffset); }
+    QList<SBYProperty> &getProperties() { return properties; }
+    void setProperties(QList<SBYProperty> newProperties) { properties = newProperties; }
+    int countProperties(QString state);
+    SBYRunProgress &getRunProgress() { return runProgress; }
+    QString getResultFile();
+    bool isStale() { return fingerprintState == FingerprintStale; }
+    bool isUpToDate() { return statusColor == 1 && fingerprintState != FingerprintStale; }
+    QString computeFingerprint();
+    void storeFingerprint(QString fingerprint);
+    void setState(QString newStatus, int color, int percent, int time);
+    void copyStatus(SBYItem &other);
+    SBYStatusRequest statusRequest();
+    static SBYStatus collectStatus(SBYStatusRequest request);
+    // returns whether anything shown for the item changed
+    bool setStatus(const SBYStatus &newStatus);
 
-    void updateFromXML(QFileInfo path);
+    void writeStatusXML(QString status, QString message, int time);
+    virtual QString getWorkDir() = 0;
     virtual void update() = 0;
     virtual bool isTop() = 0;
     virtual QString getTaskName() = 0;
+    // path of the .sby file below the workspace folder, names tasks uniquely
+    virtual QString getRelativeName() = 0;
     virtual QString getContents() = 0;
     virtual QStringList &getFiles() = 0;
     virtual QFileInfoList &getVCDFiles() = 0;
@@ -36,21 +69,37 @@ protected:
     QString status;
     int percentage;
     int timeSpent;
-    QString previousLog;
+    QString logFile;
+    qint64 logOffset;
+    int fingerprintState;
+    QList<SBYProperty> properties;
+    SBYRunProgress runProgress;
 };
 
 class SBYFile;
 
+// Tasks that differ between the loaded and a freshly parsed version of a file
+struct SBYFileDiff {
+    QStringList added;
+    QStringList removed;
+    QStringList changed;
+    bool isEmpty() { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+};
+
 class SBYTask : public SBYItem {
 public:
     SBYTask(QFileInfo path, QString name, QString content, QStringList files, SBYFile* parent);
     void update() override;
     void updateTask();
+    QString getWorkDir() override { return path.path() + "/" + path.completeBaseName() + "_" + name; }
     bool isTop() override { return false; }
     QString getTaskName() override { return name; }
+    QString getRelativeName() override;
     QString getContents() override { return content; };
     QStringList &getFiles() override { return files; }
     QFileInfoList &getVCDFiles() override { return vcdFiles; }
+    void setContents(QString newContent, QStringList newFiles) { content = newContent; files = newFiles; }
+    SBYFile *getFile() { return parent; }
 private:
     QString content;    
     SBYFile *parent;
@@ -63,16 +112,31 @@ public:
     SBYFile(QFileInfo path);
     void parse();
     bool haveTasks();
-    void refresh();
     void update() override;
+    void updateSummary();
+    QString getWorkDir() override { return path.path() + "/" + path.completeBaseName(); }
     bool isTop() override { return true; }
     QString getTaskName() override { return ""; }
-    QString getContents() override { return ""; };
+    QString getRelativeName() override { return relativeName; }
+    void setRelativeName(QString name) { relativeName = name; }
+    QString getContents() override { return configs.value(""); };
     QStringList &getFiles() override { return files; }
     QFileInfoList &getVCDFiles() override { return vcdFiles; }
     std::vector<std::unique_ptr<SBYTask>> &getTasks() { return tasks; }
     SBYTask *getTask(QString name);
     QSet<QString> &getTasksSet() { return tasksSet; }
+    QStringList &getTaskList() { return taskList; }
+    QMap<QString, QString> &getConfigs() { return configs; }
+    void setParsed(QStringList newTaskList, QMap<QString, QString> newConfigs, QMap<QString, QStringList> newFiles);
+    bool sameConfig(SBYFile &other) { return taskList == other.taskList && configs == other.configs; }
+    void takeStatus(SBYFile &other);
+    SBYFileDiff diff(SBYFile &parsed);
+    void merge(SBYFile &parsed);
+    // size, modification time and hash of the contents the tasks were read from
+    void setParsedKey(qint64 size, qint64 modified, QByteArray hash);
+    qint64 getParsedSize() { return parsedSize; }
+    qint64 getParsedModified() { return parsedModified; }
+    QByteArray getParsedHash() { return parsedHash; }
 private:
     bool parse(QFileInfo &path);
     QStringList get_config_files(QString task);
@@ -85,5 +149,9 @@ private:
     QSet<QString> tasksSet;
     QStringList files;
     QFileInfoList vcdFiles;
+    QString relativeName;
+    qint64 parsedSize;
+    qint64 parsedModified;
+    QByteArray parsedHash;
 };
 #endif // SBYITEM_H
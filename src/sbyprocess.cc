@@ -0,0 +1,68 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "sbyprocess.h"
+#include <QTimer>
+#include "procinfo.h"
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+SBYProcess::SBYProcess(QObject *parent) : QProcess(parent), session(0)
+{
+    connect(this, &QProcess::started, [=]() { session = processId(); });
+#ifdef Q_OS_UNIX
+    // sby is gone, make sure nothing it started keeps using the machine
+    connect(this, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            [=](int, QProcess::ExitStatus) { ProcessInfo::signalSession(session, {SIGKILL}); });
+#endif
+}
+
+void SBYProcess::setupChildProcess()
+{
+#ifdef Q_OS_UNIX
+    ::setsid();
+#endif
+}
+
+void SBYProcess::terminateTree(int killTimeout)
+{
+#ifdef Q_OS_UNIX
+    qint64 sid = session;
+    if (sid <= 0)
+        return;
+    ProcessInfo::signalSession(sid, {SIGTERM}, state() != QProcess::NotRunning);
+    // not bound to this object, it is usually deleted as soon as sby exits;
+    // by then only what is left in the session is ours
+    QTimer::singleShot(killTimeout, [sid]() { ProcessInfo::signalSession(sid, {SIGKILL}); });
+#else
+    Q_UNUSED(killTimeout);
+    terminate();
+#endif
+}
+
+void SBYProcess::killTree()
+{
+#ifdef Q_OS_UNIX
+    ProcessInfo::signalSession(session, {SIGSTOP, SIGKILL}, state() != QProcess::NotRunning);
+#else
+    kill();
+#endif
+}
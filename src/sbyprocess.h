@@ -0,0 +1,43 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SBYPROCESS_H
+#define SBYPROCESS_H
+
+#include <QProcess>
+
+// QProcess started in its own session, so that stopping it reaches every
+// engine and solver it spawned, including the ones sby leaves behind.
+class SBYProcess : public QProcess
+{
+    Q_OBJECT
+
+  public:
+    explicit SBYProcess(QObject *parent = 0);
+
+    void terminateTree(int killTimeout = 500);
+    void killTree();
+
+  protected:
+    void setupChildProcess() override;
+
+    qint64 session;
+};
+
+#endif // SBYPROCESS_H
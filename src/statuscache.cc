@@ -0,0 +1,132 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "statuscache.h"
+#include "fingerprint.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QXmlStreamReader>
+
+static void addStamp(QList<qint64> &stamp, QString path)
+{
+    QFileInfo info(path);
+    stamp << (info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1) << info.size();
+}
+
+StatusCache &StatusCache::instance()
+{
+    static StatusCache cache;
+    return cache;
+}
+
+// attributes only, reading stops where the log starts
+void StatusCache::readResult(QString xmlFile, SBYStatus &status)
+{
+    QFile f(xmlFile);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    int errors = 0;
+    int failures = 0;
+    bool suite = false;
+    bool testcase = false;
+    bool result = false;
+    QXmlStreamReader xml(&f);
+    while (!xml.atEnd()) {
+        qint64 offset = xml.characterOffset();
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        QXmlStreamAttributes attributes = xml.attributes();
+        if (xml.name() == QLatin1String("testsuite") && !suite) {
+            suite = true;
+            errors = attributes.value("errors").toInt();
+            failures = attributes.value("failures").toInt();
+        } else if (xml.name() == QLatin1String("testcase") && !testcase) {
+            testcase = true;
+            if (attributes.hasAttribute("time"))
+                status.timeSpent = attributes.value("time").toInt();
+            if (attributes.hasAttribute("status")) {
+                result = true;
+                status.percentage = 100;
+                status.status = attributes.value("status").toString();
+            }
+        } else if (xml.name() == QLatin1String("system-out")) {
+            status.logFile = xmlFile;
+            status.logOffset = offset;
+            break;
+        }
+    }
+    if (result)
+        status.statusColor = (errors == 0 && failures == 0) ? 1 : 2;
+}
+
+QString StatusCache::readLog(QString xmlFile, qint64 offset)
+{
+    if (offset < 0)
+        return QString();
+    QFile f(xmlFile);
+    if (!f.open(QIODevice::ReadOnly))
+        return QString();
+    // the offset counts characters, so decode before skipping to it
+    QXmlStreamReader xml(QString::fromUtf8(f.readAll()).mid(offset));
+    if (!xml.readNextStartElement() || xml.name() != QLatin1String("system-out"))
+        return QString();
+    return xml.readElementText();
+}
+
+SBYStatus StatusCache::read(QString workDir)
+{
+    QDir dir(workDir);
+    QString xmlFile = dir.filePath(dir.dirName() + ".xml");
+    QString fingerprintFile = dir.filePath(Fingerprint::fileName());
+    QString engineDir = dir.filePath("engine_0");
+
+    // a handful of stats, the directory itself is only listed when one changed
+    QList<qint64> stamp;
+    addStamp(stamp, workDir);
+    addStamp(stamp, xmlFile);
+    addStamp(stamp, fingerprintFile);
+    addStamp(stamp, engineDir);
+    addStamp(stamp, dir.filePath(StatusDatabase::fileName()));
+    addStamp(stamp, dir.filePath(StatusDatabase::fileName() + "-wal"));
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.find(workDir);
+        if (it != entries.end() && it->stamp == stamp)
+            return it->status;
+    }
+
+    SBYStatus status;
+    if (stamp[0] != -1) {
+        readResult(xmlFile, status);
+        QFile f(fingerprintFile);
+        if (f.open(QIODevice::ReadOnly))
+            status.storedFingerprint = QString(f.readAll()).trimmed();
+        if (QFileInfo(engineDir).isDir())
+            status.vcdFiles = QDir(engineDir).entryInfoList(QStringList() << "*.vcd", QDir::Files, QDir::Name);
+        StatusDatabase database(workDir);
+        database.poll();
+        status.properties = database.getProperties();
+    }
+    QMutexLocker locker(&mutex);
+    entries.insert(workDir, Entry{stamp, status});
+    return status;
+}
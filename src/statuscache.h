@@ -0,0 +1,81 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef STATUSCACHE_H
+#define STATUSCACHE_H
+
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+#include <QMutex>
+#include <QString>
+#include "statusdatabase.h"
+
+// What a run left behind in its work directory. Passed around by value,
+// so it can be collected on any thread and applied on the GUI thread. The
+// log stays in the result file, only where it starts is kept.
+struct SBYStatus
+{
+    QString status;
+    int statusColor = 0;
+    int percentage = 0;
+    int timeSpent = -1;
+    QString logFile;
+    qint64 logOffset = -1;
+    int fingerprintState = 0;
+    QString storedFingerprint;
+    QFileInfoList vcdFiles;
+    QList<SBYProperty> properties;
+};
+
+// item names as used in the task list to their status
+typedef QMap<QString, SBYStatus> SBYStatusMap;
+
+Q_DECLARE_METATYPE(SBYStatus)
+Q_DECLARE_METATYPE(SBYStatusMap)
+
+// Work directory contents by path, shared by all threads. A directory is
+// only read again when it, its result file, the stored fingerprint, the
+// status database or engine_0 got a new modification time or size.
+class StatusCache
+{
+  public:
+    static StatusCache &instance();
+
+    SBYStatus read(QString workDir);
+    static QString readLog(QString xmlFile, qint64 offset);
+
+  protected:
+    struct Entry
+    {
+        QList<qint64> stamp;
+        SBYStatus status;
+    };
+
+    StatusCache() {}
+    static void readResult(QString xmlFile, SBYStatus &status);
+
+    QHash<QString, Entry> entries;
+    QMutex mutex;
+};
+
+#endif // STATUSCACHE_H
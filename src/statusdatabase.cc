@@ -0,0 +1,139 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "statusdatabase.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QVariant>
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+// hierarchical names are stored as a JSON list
+static QString propertyName(QString name)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(name.toUtf8());
+    if (!doc.isArray())
+        return name;
+    QStringList parts;
+    for (auto part : doc.array())
+        parts << part.toString();
+    return parts.join(".");
+}
+
+// tells a database sby created anew in place of the previous one apart,
+// a connection kept open would go on reading the deleted file
+static QString fileIdentity(QString path)
+{
+    QFileInfo info(path);
+    if (!info.isFile())
+        return QString();
+    QString created = QString::number(info.birthTime().toMSecsSinceEpoch());
+#ifdef Q_OS_UNIX
+    struct stat buf;
+    if (::stat(QFile::encodeName(path).constData(), &buf) == 0)
+        return QString("%1:%2:%3").arg(buf.st_dev).arg(buf.st_ino).arg(created);
+#endif
+    return created;
+}
+
+StatusDatabase::StatusDatabase(QString workDir)
+        : path(QDir(workDir).filePath(fileName())), connection(QString("status-%1").arg(quintptr(this))),
+          lastProperty(0), lastStatus(0)
+{
+}
+
+void StatusDatabase::ignoreExisting() { ignored = fileIdentity(path); }
+
+bool StatusDatabase::poll()
+{
+    // sby creates it some time after the run started
+    QString current = fileIdentity(path);
+    if (current.isEmpty() || (!ignored.isEmpty() && current == ignored))
+        return false;
+    bool changed = false;
+    if (current != identity) {
+        identity = current;
+        changed = !properties.isEmpty();
+        lastProperty = 0;
+        lastStatus = 0;
+        propertyRows.clear();
+        nameRows.clear();
+        properties.clear();
+    }
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=1000");
+        if (db.open())
+            changed |= read(db);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return changed;
+}
+
+bool StatusDatabase::read(QSqlDatabase &db)
+{
+    bool changed = false;
+
+    QSqlQuery added(db);
+    added.prepare("SELECT id, src, name FROM task_property WHERE id > ? ORDER BY id");
+    added.addBindValue(lastProperty);
+    if (added.exec()) {
+        while (added.next()) {
+            lastProperty = added.value(0).toLongLong();
+            QString location = added.value(1).toString();
+            QString name = propertyName(added.value(2).toString());
+            // a rerun in the same directory reports the same properties again
+            QString key = location + "\n" + name;
+            if (!nameRows.contains(key)) {
+                nameRows[key] = properties.size();
+                properties << SBYProperty{name, location, "UNKNOWN"};
+                changed = true;
+            }
+            propertyRows[lastProperty] = nameRows[key];
+        }
+    }
+
+    QSqlQuery statuses(db);
+    statuses.prepare("SELECT id, task_property, status FROM task_property_status WHERE id > ? ORDER BY id");
+    statuses.addBindValue(lastStatus);
+    if (statuses.exec()) {
+        while (statuses.next()) {
+            // property added after it was queried, picked up on the next poll
+            auto row = propertyRows.find(statuses.value(1).toLongLong());
+            if (row == propertyRows.end())
+                break;
+            lastStatus = statuses.value(0).toLongLong();
+            QString status = statuses.value(2).toString();
+            if (properties[*row].status != status) {
+                properties[*row].status = status;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
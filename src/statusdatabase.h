@@ -0,0 +1,73 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef STATUSDATABASE_H
+#define STATUSDATABASE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// Latest state of one property of a task as reported by sby
+struct SBYProperty
+{
+    QString name;
+    QString location;
+    QString status;
+
+    bool operator==(const SBYProperty &other) const
+    {
+        return name == other.name && location == other.location && status == other.status;
+    }
+};
+
+class QSqlDatabase;
+
+// Reader for the status database newer sby versions keep in the work
+// directory and update as each property is proven or fails. Every poll
+// only fetches the rows added since the previous one and opens its own
+// connection, so polls may run on any thread but only one at a time.
+class StatusDatabase
+{
+  public:
+    explicit StatusDatabase(QString workDir);
+
+    static QString fileName() { return "status.sqlite"; }
+    // the database there now belongs to a previous run, sby replaces it
+    void ignoreExisting();
+    // true when properties were added or changed state
+    bool poll();
+    QList<SBYProperty> getProperties() { return properties; }
+
+  protected:
+    bool read(QSqlDatabase &db);
+
+    QString path;
+    QString connection;
+    QString ignored;
+    QString identity;
+    qint64 lastProperty;
+    qint64 lastStatus;
+    QHash<qint64, int> propertyRows;
+    QHash<QString, int> nameRows;
+    QList<SBYProperty> properties;
+};
+
+#endif // STATUSDATABASE_H
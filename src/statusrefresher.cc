@@ -0,0 +1,135 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include "statusrefresher.h"
+#include <QRunnable>
+
+class StatusJob : public QRunnable
+{
+  public:
+    StatusJob(StatusRefresher *refresher, QString fileName, QMap<QString, SBYStatusRequest> requests, int generation)
+            : refresher(refresher), fileName(fileName), requests(requests), generation(generation)
+    {
+    }
+
+    void run() override
+    {
+        SBYStatusMap statuses;
+        for (auto it = requests.begin(); it != requests.end(); ++it)
+            statuses[it.key()] = SBYItem::collectStatus(it.value());
+        Q_EMIT refresher->collected(generation, fileName, statuses);
+    }
+
+  protected:
+    StatusRefresher *refresher;
+    QString fileName;
+    QMap<QString, SBYStatusRequest> requests;
+    int generation;
+};
+
+class StatusPollJob : public QRunnable
+{
+  public:
+    StatusPollJob(StatusPoller *poller) : poller(poller) {}
+
+    void run() override { Q_EMIT poller->polled(poller->database.poll()); }
+
+  protected:
+    StatusPoller *poller;
+};
+
+StatusRefresher::StatusRefresher(QObject *parent) : QObject(parent), generation(0)
+{
+    qRegisterMetaType<SBYStatusMap>();
+    pool = new QThreadPool(this);
+    connect(this, &StatusRefresher::collected, this, [=](int jobGeneration, QString fileName, SBYStatusMap statuses) {
+        if (jobGeneration != generation)
+            return;
+        running.remove(fileName);
+        Q_EMIT refreshed(fileName, statuses);
+        if (queued.contains(fileName))
+            start(fileName, queued.take(fileName));
+    }, Qt::QueuedConnection);
+}
+
+StatusRefresher::~StatusRefresher()
+{
+    cancel();
+    pool->waitForDone();
+}
+
+void StatusRefresher::refresh(SBYFile *file)
+{
+    QString fileName = file->getRelativeName();
+    QMap<QString, SBYStatusRequest> requests;
+    if (file->haveTasks()) {
+        for (auto &task : file->getTasks())
+            requests[fileName + "#" + task->getTaskName()] = task->statusRequest();
+    } else {
+        requests[fileName] = file->statusRequest();
+    }
+    if (running.contains(fileName))
+        queued[fileName] = requests;
+    else
+        start(fileName, requests);
+}
+
+void StatusRefresher::start(QString fileName, QMap<QString, SBYStatusRequest> requests)
+{
+    running.insert(fileName);
+    pool->start(new StatusJob(this, fileName, requests, generation));
+}
+
+void StatusRefresher::cancel()
+{
+    pool->clear();
+    generation++;
+    running.clear();
+    queued.clear();
+}
+
+StatusPoller::StatusPoller(QString workDir, bool fresh) : database(workDir), busy(false), finished(false)
+{
+    if (fresh)
+        database.ignoreExisting();
+    // the database is only touched by the job until this arrives
+    connect(this, &StatusPoller::polled, this, [=](bool changed) {
+        busy = false;
+        if (finished)
+            deleteLater();
+        else if (changed)
+            Q_EMIT this->changed(database.getProperties());
+    }, Qt::QueuedConnection);
+}
+
+void StatusPoller::poll()
+{
+    if (busy || finished)
+        return;
+    busy = true;
+    QThreadPool::globalInstance()->start(new StatusPollJob(this));
+}
+
+void StatusPoller::finish()
+{
+    finished = true;
+    if (!busy)
+        deleteLater();
+}
@@ -0,0 +1,88 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#ifndef STATUSREFRESHER_H
+#define STATUSREFRESHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include "sbyitem.h"
+#include "statusdatabase.h"
+
+// Collects the status of all items of a file on a thread pool and hands
+// back snapshots on the GUI thread, reading hundreds of work directories
+// over a network file system would otherwise block the window. A file
+// that is refreshed again while its job runs is collected once more
+// afterwards.
+class StatusRefresher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit StatusRefresher(QObject *parent = 0);
+    virtual ~StatusRefresher();
+
+    void refresh(SBYFile *file);
+    void cancel();
+    bool isRefreshing() { return !running.isEmpty(); }
+
+  Q_SIGNALS:
+    void refreshed(QString fileName, SBYStatusMap statuses);
+    void collected(int generation, QString fileName, SBYStatusMap statuses);
+
+  protected:
+    void start(QString fileName, QMap<QString, SBYStatusRequest> requests);
+
+    QThreadPool *pool;
+    QSet<QString> running;
+    QHash<QString, QMap<QString, SBYStatusRequest>> queued;
+    int generation;
+};
+
+// Polls the status database of a running task on a pool thread, sqlite
+// may wait up to a second for the lock sby holds while writing. After
+// finish() it deletes itself once no poll is left in flight.
+class StatusPoller : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a fresh run ignores the database of the previous one until sby replaced it
+    StatusPoller(QString workDir, bool fresh);
+
+    // skipped while the previous poll is still going
+    void poll();
+    void finish();
+
+  Q_SIGNALS:
+    void changed(QList<SBYProperty> properties);
+    void polled(bool changed);
+
+  protected:
+    friend class StatusPollJob;
+
+    StatusDatabase database;
+    bool busy;
+    bool finished;
+};
+
+#endif // STATUSREFRESHER_H
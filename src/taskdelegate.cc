@@ -0,0 +1,219 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "taskdelegate.h"
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QFontMetrics>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include "taskmodel.h"
+
+static const int iconSize = 16;
+static const int margin = 3;
+
+TaskDelegate::TaskDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+QList<TaskDelegate::Action> TaskDelegate::actions(SBYItem *item)
+{
+    QList<Action> list;
+    list << Play << Stop << Edit;
+    // files with tasks only start and edit, the rest lives on the tasks
+    if (!item->isTop() || !static_cast<SBYFile *>(item)->haveTasks())
+        list << Log << Files << Wave;
+    return list;
+}
+
+bool TaskDelegate::isEnabled(Action action, SBYItem *item, bool running)
+{
+    switch (action) {
+    case Play:
+        return !running;
+    case Stop:
+        return running;
+    case Edit:
+        return true;
+    case Log:
+        return item->hasPreviousLog();
+    case Files:
+        return !item->getFiles().isEmpty();
+    case Wave:
+        return !item->getVCDFiles().isEmpty();
+    }
+    return false;
+}
+
+QString TaskDelegate::actionName(Action action, SBYItem *item)
+{
+    switch (action) {
+    case Play:
+        return "Play";
+    case Stop:
+        return "Stop";
+    case Edit:
+        return item->isTop() ? "Edit" : "View";
+    case Log:
+        return "Log";
+    case Files:
+        return "Files";
+    case Wave:
+        return "Wave";
+    }
+    return QString();
+}
+
+QIcon TaskDelegate::actionIcon(Action action, SBYItem *item)
+{
+    // shared by every row, loading them per paint would be noticeable
+    static QIcon play(":/icons/resources/media-playback-start.png");
+    static QIcon stop(":/icons/resources/media-playback-stop.png");
+    static QIcon edit(":/icons/resources/script_edit.png");
+    static QIcon view(":/icons/resources/script.png");
+    static QIcon log(":/icons/resources/book.png");
+    static QIcon files(":/icons/resources/page_code.png");
+    static QIcon wave(":/icons/resources/gtkwave.png");
+    switch (action) {
+    case Play:
+        return play;
+    case Stop:
+        return stop;
+    case Edit:
+        return item->isTop() ? edit : view;
+    case Log:
+        return log;
+    case Files:
+        return files;
+    case Wave:
+        return wave;
+    }
+    return QIcon();
+}
+
+QList<QPair<TaskDelegate::Action, QRect>> TaskDelegate::actionRects(const QStyleOptionViewItem &option,
+                                                                     SBYItem *item) const
+{
+    QList<QPair<Action, QRect>> rects;
+    QList<Action> list = actions(item);
+    int x = option.rect.right() - margin - list.size() * (iconSize + margin);
+    for (auto action : list) {
+        rects << qMakePair(action, QRect(x, option.rect.top() + margin, iconSize, iconSize));
+        x += iconSize + margin;
+    }
+    return rects;
+}
+
+int TaskDelegate::actionAt(const QStyleOptionViewItem &option, const QModelIndex &index, QPoint pos) const
+{
+    SBYItem *item = static_cast<const TaskModel *>(index.model())->itemAt(index);
+    if (!item)
+        return -1;
+    for (auto rect : actionRects(option, item))
+        if (rect.second.contains(pos))
+            return rect.first;
+    return -1;
+}
+
+void TaskDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    SBYItem *item = static_cast<const TaskModel *>(index.model())->itemAt(index);
+    if (!item) {
+        // directory and property rows
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+    bool running = index.data(TaskModel::RunningRole).toBool();
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+
+    painter->save();
+    QRect r = opt.rect.adjusted(margin, margin, -margin, -margin);
+    int line = qMax(iconSize, opt.fontMetrics.height());
+
+    // status, name and actions
+    opt.icon.paint(painter, QRect(r.left(), r.top(), iconSize, iconSize));
+    auto rects = actionRects(option, item);
+    int nameLeft = r.left() + iconSize + margin;
+    int nameRight = (rects.isEmpty() ? r.right() : rects.first().second.left()) - margin;
+    QFont font = opt.font;
+    font.setBold(item->isTop());
+    painter->setFont(font);
+    painter->setPen(opt.palette.color(opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text));
+    QString name = QFontMetrics(font).elidedText(opt.text, Qt::ElideMiddle, nameRight - nameLeft);
+    painter->drawText(QRect(nameLeft, r.top(), nameRight - nameLeft, line), Qt::AlignVCenter | Qt::AlignLeft, name);
+    for (auto rect : rects) {
+        bool enabled = isEnabled(rect.first, item, running);
+        actionIcon(rect.first, item).paint(painter, rect.second, Qt::AlignCenter, enabled ? QIcon::Normal : QIcon::Disabled);
+    }
+
+    // progress and last run
+    QRect bar(nameLeft, r.top() + line + margin, 120, opt.fontMetrics.height() - 2);
+    painter->setPen(opt.palette.color(QPalette::Mid));
+    painter->setBrush(opt.palette.color(QPalette::Base));
+    painter->drawRect(bar);
+    QColor color = index.data(TaskModel::ColorRole).value<QColor>();
+    color.setAlpha(255);
+    int width = bar.width() * qBound(0, index.data(TaskModel::PercentageRole).toInt(), 100) / 100;
+    if (width > 1)
+        painter->fillRect(QRect(bar.left() + 1, bar.top() + 1, width - 1, bar.height() - 1), color.lighter(130));
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text));
+    QRect text(bar.right() + 2 * margin, bar.top() - 1, r.right() - bar.right() - 2 * margin, opt.fontMetrics.height());
+    painter->drawText(text, Qt::AlignVCenter | Qt::AlignLeft, index.data(TaskModel::LastRunRole).toString());
+    painter->restore();
+}
+
+QSize TaskDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    // same height for every row so the view never has to measure them
+    int line = qMax(iconSize, option.fontMetrics.height());
+    return QSize(300, line + option.fontMetrics.height() + 3 * margin + margin);
+}
+
+bool TaskDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                               const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        QMouseEvent *mouse = static_cast<QMouseEvent *>(event);
+        int action = actionAt(option, index, mouse->pos());
+        SBYItem *item = static_cast<TaskModel *>(model)->itemAt(index);
+        if (mouse->button() == Qt::LeftButton && item && action >= 0 &&
+            isEnabled(Action(action), item, index.data(TaskModel::RunningRole).toBool())) {
+            Q_EMIT actionTriggered(index, Action(action));
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool TaskDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                             const QModelIndex &index)
+{
+    int action = actionAt(option, index, event->pos());
+    if (event->type() == QEvent::ToolTip && action >= 0) {
+        SBYItem *item = static_cast<const TaskModel *>(index.model())->itemAt(index);
+        QToolTip::showText(event->globalPos(), actionName(Action(action), item), view);
+        return true;
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
@@ -0,0 +1,70 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TASKDELEGATE_H
+#define TASKDELEGATE_H
+
+#include <QIcon>
+#include <QList>
+#include <QPair>
+#include <QRect>
+#include <QStyledItemDelegate>
+#include "sbyitem.h"
+
+// Paints a file or task row the way the old boxes looked: status, name and
+// action buttons on top, progress and last run time below. Only rows in
+// view get painted, the buttons are just areas of the row.
+class TaskDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+  public:
+    enum Action
+    {
+        Play,
+        Stop,
+        Edit,
+        Log,
+        Files,
+        Wave
+    };
+
+    explicit TaskDelegate(QObject *parent = 0);
+
+    static QList<Action> actions(SBYItem *item);
+    static bool isEnabled(Action action, SBYItem *item, bool running);
+    static QString actionName(Action action, SBYItem *item);
+    static QIcon actionIcon(Action action, SBYItem *item);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                     const QModelIndex &index) override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                   const QModelIndex &index) override;
+
+  Q_SIGNALS:
+    void actionTriggered(const QModelIndex &index, TaskDelegate::Action action);
+
+  protected:
+    QList<QPair<Action, QRect>> actionRects(const QStyleOptionViewItem &option, SBYItem *item) const;
+    int actionAt(const QStyleOptionViewItem &option, const QModelIndex &index, QPoint pos) const;
+};
+
+#endif // TASKDELEGATE_H
@@ -0,0 +1,519 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "taskmodel.h"
+#include <QColor>
+#include <QFileInfo>
+#include <QIcon>
+#include <QMap>
+
+TaskModel::TaskModel(std::vector<std::unique_ptr<SBYFile>> &files, QObject *parent)
+        : QAbstractItemModel(parent), files(files), grouped(false), updatedFile(nullptr)
+{
+}
+
+TaskModel::~TaskModel() { clearGroups(); }
+
+static QString directoryOf(SBYFile *file)
+{
+    QString dir = QFileInfo(file->getRelativeName()).path();
+    return dir == "." ? QString() : dir;
+}
+
+static bool lessThan(SBYFile *a, SBYFile *b)
+{
+    return QString::compare(a->getFileName(), b->getFileName(), Qt::CaseInsensitive) < 0;
+}
+
+// property rows carry the task they belong to with the lowest bit set,
+// items and groups are never at odd addresses
+static quintptr propertyId(SBYItem *owner)
+{
+    return quintptr(owner) | 1;
+}
+
+static bool hasProperties(SBYItem *item)
+{
+    return !item->isTop() || !static_cast<SBYFile *>(item)->haveTasks();
+}
+
+SBYItem *TaskModel::itemAt(const QModelIndex &index) const
+{
+    if (!index.isValid() || (index.internalId() & 1) || groupPointers.contains(index.internalPointer()))
+        return nullptr;
+    return static_cast<SBYItem *>(index.internalPointer());
+}
+
+SBYItem *TaskModel::propertyOwner(const QModelIndex &index) const
+{
+    if (!index.isValid() || !(index.internalId() & 1))
+        return nullptr;
+    return reinterpret_cast<SBYItem *>(index.internalId() & ~quintptr(1));
+}
+
+int TaskModel::propertyCount(SBYItem *item) const
+{
+    if (!hasProperties(item))
+        return 0;
+    auto it = propertyRows.find(item);
+    if (it == propertyRows.end())
+        it = propertyRows.insert(item, item->getProperties().size());
+    return *it;
+}
+
+// before the items of the file go away or change
+void TaskModel::forgetProperties(SBYFile *file)
+{
+    propertyRows.remove(file);
+    for (auto &task : file->getTasks())
+        propertyRows.remove(task.get());
+}
+
+void TaskModel::numberTasks(SBYFile *file)
+{
+    auto &tasks = file->getTasks();
+    for (size_t i = 0; i < tasks.size(); i++)
+        taskRows[tasks[i].get()] = int(i);
+}
+
+// before the tasks go away, their addresses may be reused
+void TaskModel::forgetTasks(SBYFile *file)
+{
+    for (auto &task : file->getTasks())
+        taskRows.remove(task.get());
+}
+
+TaskGroup *TaskModel::groupAt(const QModelIndex &index) const
+{
+    if (!index.isValid() || (index.internalId() & 1) || !groupPointers.contains(index.internalPointer()))
+        return nullptr;
+    return static_cast<TaskGroup *>(index.internalPointer());
+}
+
+QModelIndex TaskModel::groupIndex(TaskGroup *group) const
+{
+    return grouped ? createIndex(groups.indexOf(group), 0, group) : QModelIndex();
+}
+
+// row of the group for dir, or where it would have to be inserted
+int TaskModel::groupRow(QString dir) const
+{
+    int row = 0;
+    while (row < groups.size() && QString::compare(groups[row]->dir, dir, Qt::CaseInsensitive) < 0)
+        row++;
+    return row;
+}
+
+int TaskModel::fileRow(TaskGroup *group, SBYFile *file) const
+{
+    if (rows.contains(file))
+        return rows[file];
+    int row = 0;
+    while (row < group->files.size() && lessThan(group->files[row], file))
+        row++;
+    return row;
+}
+
+// a workspace with all files next to each other stays a flat list
+bool TaskModel::needsGroups(QString extraDir) const
+{
+    if (!extraDir.isEmpty())
+        return true;
+    for (auto group : groups)
+        if (!group->dir.isEmpty())
+            return true;
+    return false;
+}
+
+void TaskModel::insertSorted(SBYFile *file)
+{
+    QString dir = directoryOf(file);
+    int row = groupRow(dir);
+    if (row == groups.size() || groups[row]->dir != dir) {
+        TaskGroup *group = new TaskGroup{dir, QList<SBYFile *>()};
+        groups.insert(row, group);
+        groupPointers.insert(group);
+    }
+    TaskGroup *group = groups[row];
+    group->files.insert(fileRow(group, file), file);
+    groupOf.insert(file, group);
+    renumber(group);
+}
+
+// parent() asks for file rows all the time, keep them at hand
+void TaskModel::renumber(TaskGroup *group)
+{
+    for (int i = 0; i < group->files.size(); i++)
+        rows[group->files[i]] = i;
+}
+
+void TaskModel::clearGroups()
+{
+    qDeleteAll(groups);
+    groups.clear();
+    groupOf.clear();
+    rows.clear();
+    taskRows.clear();
+    groupPointers.clear();
+    propertyRows.clear();
+}
+
+QModelIndex TaskModel::indexOf(SBYItem *item) const
+{
+    if (!item)
+        return QModelIndex();
+    if (item->isTop()) {
+        SBYFile *file = static_cast<SBYFile *>(item);
+        TaskGroup *group = groupOf.value(file);
+        return group ? createIndex(rows.value(file), 0, item) : QModelIndex();
+    }
+    auto row = taskRows.find(item);
+    return row != taskRows.end() ? createIndex(*row, 0, item) : QModelIndex();
+}
+
+void TaskModel::itemChanged(SBYItem *item)
+{
+    QModelIndex index = indexOf(item);
+    if (!index.isValid())
+        return;
+    Q_EMIT dataChanged(index, index);
+    auto known = propertyRows.find(item);
+    if (known == propertyRows.end())
+        return;
+    int count = hasProperties(item) ? item->getProperties().size() : 0;
+    if (count > *known) {
+        beginInsertRows(index, *known, count - 1);
+        *known = count;
+        endInsertRows();
+    } else if (count < *known) {
+        beginRemoveRows(index, count, *known - 1);
+        *known = count;
+        endRemoveRows();
+    }
+    if (count > 0)
+        Q_EMIT dataChanged(createIndex(0, 0, propertyId(item)), createIndex(count - 1, 0, propertyId(item)));
+}
+
+void TaskModel::addFile(SBYFile *file)
+{
+    forgetProperties(file);
+    numberTasks(file);
+    QString dir = directoryOf(file);
+    if (needsGroups(dir) != grouped) {
+        beginResetModel();
+        insertSorted(file);
+        grouped = true;
+        endResetModel();
+        return;
+    }
+    int row = groupRow(dir);
+    if (row == groups.size() || groups[row]->dir != dir) {
+        if (grouped)
+            beginInsertRows(QModelIndex(), row, row);
+        else
+            beginInsertRows(QModelIndex(), 0, 0);
+        insertSorted(file);
+        endInsertRows();
+        return;
+    }
+    TaskGroup *group = groups[row];
+    int position = fileRow(group, file);
+    beginInsertRows(groupIndex(group), position, position);
+    insertSorted(file);
+    endInsertRows();
+}
+
+void TaskModel::removeFile(SBYFile *file)
+{
+    TaskGroup *group = groupOf.value(file);
+    if (!group)
+        return;
+    forgetProperties(file);
+    forgetTasks(file);
+    if (group->files.size() == 1) {
+        bool stillGrouped = false;
+        for (auto other : groups)
+            if (other != group && !other->dir.isEmpty())
+                stillGrouped = true;
+        if (grouped && !stillGrouped && groups.size() > 1) {
+            // the last subdirectory is gone, back to a flat list
+            beginResetModel();
+            groups.removeOne(group);
+            groupPointers.remove(group);
+            groupOf.remove(file);
+            rows.remove(file);
+            delete group;
+            grouped = false;
+            endResetModel();
+            return;
+        }
+        int row = grouped ? groups.indexOf(group) : 0;
+        beginRemoveRows(QModelIndex(), row, row);
+        groups.removeOne(group);
+        groupPointers.remove(group);
+        groupOf.remove(file);
+        rows.remove(file);
+        delete group;
+        grouped = grouped && !groups.isEmpty();
+        endRemoveRows();
+        return;
+    }
+    int row = rows.value(file);
+    beginRemoveRows(groupIndex(group), row, row);
+    group->files.removeAt(row);
+    groupOf.remove(file);
+    rows.remove(file);
+    renumber(group);
+    endRemoveRows();
+}
+
+void TaskModel::beginUpdateFile(SBYFile *file)
+{
+    Q_EMIT layoutAboutToBeChanged(QList<QPersistentModelIndex>() << QPersistentModelIndex(indexOf(file)));
+    // removed tasks are gone by the time the layout is done, remember
+    // which file each row belonged to instead of asking the task later
+    updatedFile = file;
+    pendingRows.clear();
+    for (auto index : persistentIndexList()) {
+        SBYItem *item = itemAt(index);
+        if (SBYItem *owner = propertyOwner(index))
+            item = owner;
+        if (!item)
+            pendingRows << qMakePair((SBYFile *)nullptr, (SBYItem *)nullptr);
+        else
+            pendingRows << qMakePair(item->isTop() ? static_cast<SBYFile *>(item) : static_cast<SBYTask *>(item)->getFile(), item);
+    }
+    forgetProperties(file);
+    forgetTasks(file);
+}
+
+void TaskModel::endUpdateFile()
+{
+    // tasks created meanwhile may sit where removed ones were
+    forgetProperties(updatedFile);
+    numberTasks(updatedFile);
+    QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    for (int i = 0; i < from.size(); i++) {
+        SBYFile *owner = pendingRows[i].first;
+        SBYItem *item = pendingRows[i].second;
+        QModelIndex index;
+        if (!owner) {
+            index = from[i];
+        } else {
+            // removed tasks are no longer numbered
+            index = indexOf(item);
+        }
+        if (index.isValid() && propertyOwner(from[i]))
+            index = from[i].row() < propertyCount(item) ? createIndex(from[i].row(), 0, propertyId(item)) : QModelIndex();
+        to << index;
+    }
+    changePersistentIndexList(from, to);
+    pendingRows.clear();
+    Q_EMIT layoutChanged(QList<QPersistentModelIndex>() << QPersistentModelIndex(indexOf(updatedFile)));
+}
+
+void TaskModel::beginReload() { beginResetModel(); }
+
+void TaskModel::endReload()
+{
+    clearGroups();
+    for (auto &file : files) {
+        insertSorted(file.get());
+        numberTasks(file.get());
+    }
+    grouped = needsGroups(QString());
+    endResetModel();
+}
+
+QModelIndex TaskModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0)
+        return QModelIndex();
+    if (!parent.isValid()) {
+        if (grouped)
+            return row < groups.size() ? createIndex(row, 0, groups[row]) : QModelIndex();
+        if (groups.isEmpty() || row >= groups[0]->files.size())
+            return QModelIndex();
+        return createIndex(row, 0, groups[0]->files[row]);
+    }
+    if (TaskGroup *group = groupAt(parent))
+        return row < group->files.size() ? createIndex(row, 0, group->files[row]) : QModelIndex();
+    SBYItem *item = itemAt(parent);
+    if (!item)
+        return QModelIndex();
+    if (hasProperties(item))
+        return row < propertyCount(item) ? createIndex(row, 0, propertyId(item)) : QModelIndex();
+    auto &tasks = static_cast<SBYFile *>(item)->getTasks();
+    return row < int(tasks.size()) ? createIndex(row, 0, tasks[row].get()) : QModelIndex();
+}
+
+QModelIndex TaskModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || groupAt(child))
+        return QModelIndex();
+    if (SBYItem *owner = propertyOwner(child))
+        return indexOf(owner);
+    SBYItem *item = itemAt(child);
+    if (item->isTop())
+        return groupIndex(groupOf.value(static_cast<SBYFile *>(item)));
+    return indexOf(static_cast<SBYTask *>(item)->getFile());
+}
+
+int TaskModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        if (grouped)
+            return groups.size();
+        return groups.isEmpty() ? 0 : groups[0]->files.size();
+    }
+    if (TaskGroup *group = groupAt(parent))
+        return group->files.size();
+    SBYItem *item = itemAt(parent);
+    if (!item)
+        return 0;
+    return hasProperties(item) ? propertyCount(item) : int(static_cast<SBYFile *>(item)->getTasks().size());
+}
+
+int TaskModel::columnCount(const QModelIndex &) const { return 1; }
+
+static QIcon statusIcon(QString status)
+{
+    static QMap<QString, QIcon> icons;
+    if (icons.isEmpty()) {
+        icons["PASS"] = QIcon(":/icons/resources/accept.png");
+        icons["FAIL"] = QIcon(":/icons/resources/cancel.png");
+        icons["ERROR"] = QIcon(":/icons/resources/delete.png");
+        icons["TIMEOUT"] = QIcon(":/icons/resources/time.png");
+        icons["MEMOUT"] = QIcon(":/icons/resources/dialog-error.png");
+        icons[""] = QIcon(":/icons/resources/question.png");
+    }
+    return icons.value(status, icons[""]);
+}
+
+static QString statusText(QString status)
+{
+    if (status == "PASS")
+        return "Pass";
+    if (status == "FAIL")
+        return "Fail";
+    if (status == "ERROR")
+        return "Error";
+    if (status == "TIMEOUT")
+        return "Timeout";
+    if (status == "MEMOUT")
+        return "Out of memory";
+    return "Unknown";
+}
+
+// live counts while sby runs, the final ones after
+static QString propertySummary(SBYItem *item)
+{
+    if (item->getProperties().isEmpty())
+        return QString();
+    return QString(", %1 pass, %2 fail, %3 unknown")
+            .arg(item->countProperties("PASS"))
+            .arg(item->countProperties("FAIL"))
+            .arg(item->countProperties("UNKNOWN"));
+}
+
+QVariant TaskModel::data(const QModelIndex &index, int role) const
+{
+    if (SBYItem *owner = propertyOwner(index)) {
+        if (index.row() >= owner->getProperties().size())
+            return QVariant();
+        const SBYProperty &property = owner->getProperties()[index.row()];
+        if (role == Qt::DisplayRole)
+            return property.name;
+        if (role == Qt::DecorationRole)
+            return statusIcon(property.status);
+        if (role == Qt::ToolTipRole)
+            return property.location + ": " + statusText(property.status);
+        return QVariant();
+    }
+    if (TaskGroup *group = groupAt(index)) {
+        if (role == Qt::DisplayRole)
+            return group->dir.isEmpty() ? QString(".") : group->dir;
+        if (role == Qt::DecorationRole)
+            return QIcon(":/icons/resources/folder-open.png");
+        return QVariant();
+    }
+    SBYItem *item = itemAt(index);
+    if (!item)
+        return QVariant();
+    bool running = runningCheck && runningCheck(item);
+    switch (role) {
+    case Qt::DisplayRole:
+        return item->isTop() ? item->getFileName() : item->getName();
+    case Qt::DecorationRole:
+        return statusIcon(item->getStatus());
+    case Qt::ToolTipRole: {
+        QString tip = (item->isTop() ? item->getRelativeName() : item->getRelativeName() + "#" + item->getName()) +
+                      ": " + (running ? QString("Running") : statusText(item->getStatus()));
+        if (running) {
+            SBYRunProgress &progress = item->getRunProgress();
+            for (auto it = progress.engineStates.begin(); it != progress.engineStates.end(); ++it)
+                tip += "\n" + it.key() + " (" + progress.engineModes.value(it.key()) + "): " + it.value();
+        }
+        return tip;
+    }
+    case RunningRole:
+        return running;
+    case PercentageRole:
+        if (running && item->getRunProgress().percentage() >= 0)
+            return item->getRunProgress().percentage();
+        if (running && !item->getProperties().isEmpty())
+            return 100 * (item->getProperties().size() - item->countProperties("UNKNOWN")) / item->getProperties().size();
+        return running ? 50 : item->getPercentage();
+    case ColorRole:
+        if (running)
+            return QColor(0, 0, 255, 127);
+        if (item->isStale())
+            return QColor(255, 140, 0, 127);
+        switch (item->getStatusColor()) {
+        case 1:
+            return QColor(0, 255, 0, 127);
+        case 2:
+            return QColor(255, 0, 0, 127);
+        default:
+            return QColor(255, 255, 0, 127);
+        }
+    case LastRunRole: {
+        if (item->isTop() && static_cast<SBYFile *>(item)->haveTasks())
+            return QString();
+        if (running) {
+            SBYRunProgress &progress = item->getRunProgress();
+            if (progress.step < 0)
+                return "Running" + propertySummary(item);
+            return QString("Running, step %1 of %2").arg(progress.step).arg(progress.depth) + propertySummary(item);
+        }
+        QString time = "Last run: ";
+        if (item->getTimeSpent() != -1)
+            time += QString::number(item->getTimeSpent()) + " sec";
+        else
+            time += "??? sec";
+        if (item->isStale())
+            time += " (stale)";
+        else if (item->isUpToDate())
+            time += " (up to date)";
+        return time + propertySummary(item);
+    }
+    }
+    return QVariant();
+}
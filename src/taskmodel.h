@@ -0,0 +1,113 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TASKMODEL_H
+#define TASKMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "sbyitem.h"
+
+// Files of one directory below the workspace folder
+struct TaskGroup
+{
+    QString dir;
+    QList<SBYFile *> files;
+};
+
+// Files and their tasks as a tree, grouped by directory as soon as any
+// file is not in the workspace folder itself. Rows point straight at the
+// SBYFile and SBYTask objects so nothing gets copied per task, properties
+// reported by sby are listed below the task they belong to. Whoever owns
+// the files reports structural changes through the calls below.
+class TaskModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+  public:
+    enum Roles
+    {
+        RunningRole = Qt::UserRole,
+        PercentageRole,
+        ColorRole,
+        LastRunRole
+    };
+
+    TaskModel(std::vector<std::unique_ptr<SBYFile>> &files, QObject *parent = 0);
+    virtual ~TaskModel();
+
+    void setRunningCheck(std::function<bool(SBYItem *)> check) { runningCheck = check; }
+    SBYItem *itemAt(const QModelIndex &index) const;
+    SBYItem *propertyOwner(const QModelIndex &index) const;
+    bool isGrouped() { return grouped; }
+    QModelIndex indexOf(SBYItem *item) const;
+    // also picks up properties added or removed since the last call
+    void itemChanged(SBYItem *item);
+
+    // after the file was added to the owner, and before it is destroyed
+    void addFile(SBYFile *file);
+    void removeFile(SBYFile *file);
+    // tasks of one file added, removed or reordered, expanded rows survive
+    void beginUpdateFile(SBYFile *file);
+    void endUpdateFile();
+    void beginReload();
+    void endReload();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+  protected:
+    TaskGroup *groupAt(const QModelIndex &index) const;
+    QModelIndex groupIndex(TaskGroup *group) const;
+    int groupRow(QString dir) const;
+    int fileRow(TaskGroup *group, SBYFile *file) const;
+    bool needsGroups(QString extraDir) const;
+    void insertSorted(SBYFile *file);
+    void clearGroups();
+    void renumber(TaskGroup *group);
+    int propertyCount(SBYItem *item) const;
+    void forgetProperties(SBYFile *file);
+    void numberTasks(SBYFile *file);
+    void forgetTasks(SBYFile *file);
+
+    std::vector<std::unique_ptr<SBYFile>> &files;
+    QList<TaskGroup *> groups;
+    QHash<SBYFile *, TaskGroup *> groupOf;
+    QHash<SBYFile *, int> rows;
+    // same for tasks, which parent() of every property row needs
+    QHash<SBYItem *, int> taskRows;
+    QSet<void *> groupPointers;
+    bool grouped;
+    std::function<bool(SBYItem *)> runningCheck;
+    SBYFile *updatedFile;
+    QList<QPair<SBYFile *, SBYItem *>> pendingRows;
+    // property rows the views were told about, per task
+    mutable QHash<SBYItem *, int> propertyRows;
+};
+
+#endif // TASKMODEL_H
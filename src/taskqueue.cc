@@ -0,0 +1,277 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "taskqueue.h"
+#include <QDateTime>
+#include <QThread>
+#include "procinfo.h"
+#include <algorithm>
+
+TaskQueue::TaskQueue(QObject *parent)
+        : QObject(parent), maxJobs(QThread::idealThreadCount()), scheduling(false), jobServer(nullptr), heldTokens(0),
+          policy(FileOrder), sequence(0), memoryReserve(0), waitingForMemory(false), remoteSlots(0)
+{
+    admissionTimer = new QTimer(this);
+    admissionTimer->setSingleShot(true);
+    admissionTimer->setInterval(2000);
+    connect(admissionTimer, &QTimer::timeout, [=]() { schedule(); });
+    if (maxJobs < 1)
+        maxJobs = 1;
+}
+
+void TaskQueue::setMaxJobs(int jobs)
+{
+    maxJobs = std::max(jobs, 1);
+    schedule();
+}
+
+void TaskQueue::setRemoteSlots(int slots)
+{
+    remoteSlots = slots;
+    schedule();
+}
+
+void TaskQueue::setJobServer(JobServer *server)
+{
+    jobServer = server;
+    connect(jobServer, &JobServer::tokenAvailable, [=]() { schedule(); });
+}
+
+void TaskQueue::releaseToken()
+{
+    // first running task uses the implicit token, like a top level make
+    if (jobServer && heldTokens > std::max(localRunning() - 1, 0)) {
+        heldTokens--;
+        jobServer->release();
+    }
+}
+
+void TaskQueue::setPolicy(Policy newPolicy)
+{
+    policy = newPolicy;
+    std::stable_sort(queued.begin(), queued.end(),
+                     [=](const QString &a, const QString &b) { return runsBefore(a, b); });
+    Q_EMIT changed();
+}
+
+bool TaskQueue::runsBefore(const QString &a, const QString &b)
+{
+    switch (policy) {
+    case LongestFirst:
+        if (estimates.value(a) != estimates.value(b))
+            return estimates.value(a) > estimates.value(b);
+        break;
+    case ShortestFirst:
+        if (estimates.value(a) != estimates.value(b))
+            return estimates.value(a) < estimates.value(b);
+        break;
+    default:
+        break;
+    }
+    return order.value(a) < order.value(b);
+}
+
+QMap<QString, int> TaskQueue::predictFinish()
+{
+    // greedy list scheduling of the queue on the available slots
+    QMap<QString, int> finish;
+    std::vector<int> slots;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto name : running) {
+        int elapsed = int((now - startedAt.value(name)) / 1000);
+        int remaining = std::max(estimates.value(name) - elapsed, 0);
+        finish[name] = remaining;
+        slots.push_back(remaining);
+    }
+    while ((int)slots.size() < maxJobs + remoteSlots)
+        slots.push_back(0);
+    for (auto name : queued) {
+        auto slot = std::min_element(slots.begin(), slots.end());
+        *slot += estimates.value(name);
+        finish[name] = *slot;
+    }
+    return finish;
+}
+
+bool TaskQueue::isQueued(QString name)
+{
+    return std::find(queued.begin(), queued.end(), name) != queued.end();
+}
+
+bool TaskQueue::enqueue(QString name, int estimate)
+{
+    if (isQueued(name) || isRunning(name))
+        return false;
+    done.removeAll(name);
+    order[name] = sequence++;
+    estimates[name] = estimate;
+    auto pos = std::upper_bound(queued.begin(), queued.end(), name,
+                                [=](const QString &a, const QString &b) { return runsBefore(a, b); });
+    queued.insert(pos, name);
+    schedule();
+    return true;
+}
+
+void TaskQueue::adopt(QString name, qint64 started, int estimate)
+{
+    if (isQueued(name) || isRunning(name))
+        return;
+    done.removeAll(name);
+    order[name] = sequence++;
+    estimates[name] = estimate;
+    startedAt[name] = started;
+    // started without a token, releaseToken() only hands back ones taken here
+    running << name;
+    Q_EMIT changed();
+}
+
+// bookkeeping of a task that is neither queued nor running any more
+void TaskQueue::forget(QString name)
+{
+    order.remove(name);
+    estimates.remove(name);
+    startedAt.remove(name);
+}
+
+void TaskQueue::finished(QString name)
+{
+    if (!running.removeAll(name))
+        return;
+    remote.removeAll(name);
+    forget(name);
+    releaseToken();
+    done.removeAll(name);
+    done << name;
+    schedule();
+}
+
+void TaskQueue::remoteUnavailable(QString name)
+{
+    if (!remote.removeAll(name))
+        return;
+    running.removeAll(name);
+    startedAt.remove(name);
+    remoteSlots = remote.size();
+    queued.push_front(name);
+    schedule();
+}
+
+void TaskQueue::remove(QString name)
+{
+    queued.erase(std::remove(queued.begin(), queued.end(), name), queued.end());
+    if (running.removeAll(name)) {
+        remote.removeAll(name);
+        releaseToken();
+    }
+    forget(name);
+    done.removeAll(name);
+    schedule();
+}
+
+void TaskQueue::removeQueued(QStringList names)
+{
+    queued.erase(std::remove_if(queued.begin(), queued.end(), [=](const QString &name) { return names.contains(name); }),
+                 queued.end());
+    for (auto name : names)
+        if (!running.contains(name))
+            forget(name);
+    Q_EMIT changed();
+    if (isIdle())
+        Q_EMIT idle();
+}
+
+void TaskQueue::clearQueued()
+{
+    for (auto name : queued)
+        forget(name);
+    queued.clear();
+    Q_EMIT changed();
+    if (isIdle())
+        Q_EMIT idle();
+}
+
+void TaskQueue::clear()
+{
+    queued.clear();
+    running.clear();
+    remote.clear();
+    done.clear();
+    order.clear();
+    estimates.clear();
+    startedAt.clear();
+    heldTokens = 0;
+    if (jobServer)
+        jobServer->reset();
+    Q_EMIT changed();
+    Q_EMIT idle();
+}
+
+void TaskQueue::schedule()
+{
+    // launch() may finish a task synchronously (e.g. sby not found),
+    // the loop below picks up the freed slot in that case
+    if (scheduling)
+        return;
+    scheduling = true;
+    waitingForMemory = false;
+    while (!queued.empty()) {
+        // workers come first, they take neither local memory nor tokens
+        if (remote.size() < remoteSlots) {
+            QString name = queued.front();
+            queued.pop_front();
+            running << name;
+            remote << name;
+            startedAt[name] = QDateTime::currentMSecsSinceEpoch();
+            Q_EMIT launch(name);
+            continue;
+        }
+        if (localRunning() >= maxJobs)
+            break;
+        // always allow one task, otherwise the queue could never drain
+        if (memoryReserve > 0 && localRunning() > 0) {
+            qint64 available = ProcessInfo::availableMemory();
+            if (available >= 0 && available < memoryReserve) {
+                waitingForMemory = true;
+                admissionTimer->start();
+                break;
+            }
+        }
+        if (jobServer && localRunning() > 0) {
+            if (!jobServer->acquire()) {
+                jobServer->waitForToken();
+                break;
+            }
+            heldTokens++;
+        }
+        QString name = queued.front();
+        queued.pop_front();
+        running << name;
+        startedAt[name] = QDateTime::currentMSecsSinceEpoch();
+        Q_EMIT launch(name);
+    }
+    scheduling = false;
+    Q_EMIT changed();
+    if (isIdle()) {
+        if (jobServer) {
+            heldTokens = 0;
+            jobServer->reset();
+        }
+        Q_EMIT idle();
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TASKQUEUE_H
+#define TASKQUEUE_H
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <deque>
+#include "jobserver.h"
+
+// Keeps track of queued, running and finished tasks and launches
+// queued ones as long as there are free slots.
+class TaskQueue : public QObject
+{
+    Q_OBJECT
+
+  public:
+    enum Policy
+    {
+        FileOrder,
+        LongestFirst,
+        ShortestFirst
+    };
+
+    explicit TaskQueue(QObject *parent = 0);
+
+    void setMaxJobs(int jobs);
+    int getMaxJobs() { return maxJobs; }
+    void setJobServer(JobServer *server);
+    void setPolicy(Policy newPolicy);
+    Policy getPolicy() { return policy; }
+    void setMemoryReserve(qint64 bytes) { memoryReserve = bytes; }
+    void setRemoteSlots(int slots);
+    bool isWaitingForMemory() { return waitingForMemory; }
+
+    bool enqueue(QString name, int estimate = 0);
+    // counts a task that is already running, e.g. one left by an earlier GUI
+    void adopt(QString name, qint64 started, int estimate = 0);
+    void finished(QString name);
+    // launched for a worker that had no slot left after all, it goes
+    // back to the front and runs locally unless the workers report again
+    void remoteUnavailable(QString name);
+    void remove(QString name);
+    void removeQueued(QStringList names);
+    void clearQueued();
+    void clear();
+
+    bool isIdle() { return queued.empty() && running.isEmpty(); }
+    bool isQueued(QString name);
+    bool isRunning(QString name) { return running.contains(name); }
+    bool isRemote(QString name) { return remote.contains(name); }
+    const std::deque<QString> &getQueued() { return queued; }
+    const QStringList &getRunning() { return running; }
+    const QStringList &getDone() { return done; }
+    int getEstimate(QString name) { return estimates.value(name); }
+    QMap<QString, int> predictFinish();
+
+  Q_SIGNALS:
+    void launch(QString name);
+    void changed();
+    void idle();
+
+  protected:
+    void schedule();
+    void releaseToken();
+    void forget(QString name);
+    int localRunning() { return running.size() - remote.size(); }
+    bool runsBefore(const QString &a, const QString &b);
+
+    int maxJobs;
+    bool scheduling;
+    JobServer *jobServer;
+    int heldTokens;
+    Policy policy;
+    quint64 sequence;
+    QMap<QString, quint64> order;
+    QMap<QString, int> estimates;
+    QMap<QString, qint64> startedAt;
+    qint64 memoryReserve;
+    bool waitingForMemory;
+    QTimer *admissionTimer;
+    int remoteSlots;
+    std::deque<QString> queued;
+    QStringList running;
+    QStringList remote;
+    QStringList done;
+};
+
+#endif // TASKQUEUE_H
@@ -0,0 +1,337 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "taskrunner.h"
+#include <QUrl>
+#include "resultcache.h"
+#include "sbyconfig.h"
+
+TaskRunner::TaskRunner(SBYItem *item, QObject *parent)
+        : QObject(parent), item(item), process(nullptr), remote(nullptr), detached(nullptr), released(false),
+          stopRequested(false), runStartedAt(0), statusPoller(nullptr)
+{
+    pollTimer = new QTimer(this);
+    pollTimer->setInterval(2000);
+    connect(pollTimer, &QTimer::timeout, this, &TaskRunner::pollStatus);
+    // a burst of steps becomes one update
+    progressTimer = new QTimer(this);
+    progressTimer->setSingleShot(true);
+    progressTimer->setInterval(250);
+    connect(progressTimer, &QTimer::timeout, this, &TaskRunner::progress);
+}
+
+TaskRunner::~TaskRunner()
+{
+    releaseWorkDir();
+    stopWatching();
+    if (remote) {
+        remote->stop();
+        delete remote;
+    }
+    if (detached) {
+        detached->disconnect();
+        if (!released)
+            detached->terminateTree();
+        delete detached;
+    }
+    if (process) {
+        process->disconnect();
+        process->terminateTree();
+        if (!process->waitForFinished(500)) {
+            process->killTree();
+            process->waitForFinished();
+        }
+        process->close();
+        delete process;
+    }
+}
+
+QString TaskRunner::getName()
+{
+    if (item->isTop())
+        return item->getRelativeName();
+    else
+        return item->getRelativeName() + "#" + item->getName();
+}
+
+QString TaskRunner::logFile()
+{
+    // one per task, names carry slashes and '#'
+    return QDir(runDirectory).filePath(QString::fromLatin1(QUrl::toPercentEncoding(getName())) + ".log");
+}
+
+qint64 TaskRunner::processId()
+{
+    if (detached)
+        return detached->processId();
+    return process ? process->processId() : 0;
+}
+
+DetachedState TaskRunner::detachedState()
+{
+    DetachedState state;
+    if (!detached)
+        return state;
+    state.pid = detached->processId();
+    state.offset = detached->getOffset();
+    state.startedAt = runStartedAt;
+    state.fingerprint = runFingerprint;
+    return state;
+}
+
+// nothing restores cached results into the directory sby is working in
+void TaskRunner::claimWorkDir()
+{
+    claimedDir = item->getWorkDir();
+    ResultCache::instance().claim(claimedDir);
+}
+
+void TaskRunner::releaseWorkDir()
+{
+    if (claimedDir.isEmpty())
+        return;
+    ResultCache::instance().release(claimedDir);
+    claimedDir.clear();
+}
+
+void TaskRunner::prepareRun(qint64 started)
+{
+    claimWorkDir();
+    killStatus.clear();
+    runStartedAt = started;
+    parser.reset();
+    item->getRunProgress() = SBYRunProgress();
+    QString depth = SBYConfig::option(item->getContents(), "depth");
+    item->getRunProgress().depth = depth.isEmpty() ? 20 : depth.toInt();
+}
+
+void TaskRunner::watchProperties(bool fresh)
+{
+    // sby keeps per property state in the work directory while it runs
+    item->setProperties(QList<SBYProperty>());
+    statusPoller = new StatusPoller(item->getWorkDir(), fresh);
+    connect(statusPoller, &StatusPoller::changed, this, [=](QList<SBYProperty> properties) {
+        item->setProperties(properties);
+        Q_EMIT progress();
+    });
+    pollTimer->start();
+}
+
+void TaskRunner::stopWatching()
+{
+    pollTimer->stop();
+    if (statusPoller)
+        statusPoller->finish();
+    statusPoller = nullptr;
+}
+
+int TaskRunner::elapsedSeconds() { return int((QDateTime::currentMSecsSinceEpoch() - runStartedAt) / 1000); }
+
+void TaskRunner::start(QProcessEnvironment env, WorkerPool *pool)
+{
+    runFingerprint = item->computeFingerprint();
+    ResultCache &cache = ResultCache::instance();
+    if (!cache.isEnabled()) {
+        launch(env, pool);
+        return;
+    }
+    // the copy happens on another thread, sby starts once the cache answered
+    int ticket = cache.restoreLater(runFingerprint, item->getWorkDir());
+    restoring = connect(&cache, &ResultCache::restored, this, [=](int answered, bool restored) {
+        if (answered != ticket)
+            return;
+        disconnect(restoring);
+        if (restored) {
+            Q_EMIT output("Result of " + getName() + " restored from cache\n");
+            item->update();
+            Q_EMIT finished(0);
+        } else if (stopRequested) {
+            Q_EMIT output(QString("---TASK STOPPED---\n"));
+            Q_EMIT finished(-1);
+        } else {
+            launch(env, pool);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TaskRunner::launch(QProcessEnvironment env, WorkerPool *pool)
+{
+    prepareRun(QDateTime::currentMSecsSinceEpoch());
+    if (pool && (remote = pool->start(item))) {
+        Q_EMIT output("Running " + getName() + " on " + remote->getWorker() + "\n");
+        connect(remote, &RemoteRun::output, this, &TaskRunner::processOutput);
+        connect(remote, &RemoteRun::finished, [=](int exitCode, QString error) {
+            if (!error.isEmpty() && killStatus.isEmpty()) {
+                item->writeStatusXML("ERROR", error, elapsedSeconds());
+                Q_EMIT output("---" + error + "---\n");
+            }
+            remote->deleteLater();
+            remote = nullptr;
+            runFinished(exitCode);
+        });
+        Q_EMIT started();
+        return;
+    }
+
+    watchProperties(true);
+    QStringList args;
+    args << "-f";
+    args << item->getFileName();
+    if (!item->isTop()) {
+        args << item->getTaskName();
+    }
+    //env.insert("YOSYS_NOVERIFIC","1");
+    env.insert("PYTHONUNBUFFERED", "1");
+
+    if (!runDirectory.isEmpty() && DetachedRun::isSupported()) {
+        QDir().mkpath(runDirectory);
+        detached = new DetachedRun(logFile(), this);
+        if (!detached->start(args, item->getWorkFolder(), env)) {
+            delete detached;
+            detached = nullptr;
+            failedToStart();
+            return;
+        }
+        connectDetached();
+        Q_EMIT started();
+        return;
+    }
+
+    process = new SBYProcess;
+    process->setProgram("sby");
+    process->setArguments(args);
+    process->setProcessEnvironment(env);
+    process->setWorkingDirectory(item->getWorkFolder());
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(process, &QProcess::readyReadStandardOutput,
+            [=]() { processOutput(QString(process->readAllStandardOutput())); });
+    connect(process, &QProcess::errorOccurred, [=](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        process->deleteLater();
+        process = nullptr;
+        failedToStart();
+    });
+    connect(process, &QProcess::started, this, &TaskRunner::started);
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            [=](int exitCode, QProcess::ExitStatus) {
+                process->deleteLater();
+                process = nullptr;
+                runFinished(exitCode);
+            });
+    process->start();
+}
+
+bool TaskRunner::attach(const DetachedState &state)
+{
+    detached = new DetachedRun(logFile(), this);
+    if (!detached->attach(state.pid, state.offset)) {
+        delete detached;
+        detached = nullptr;
+        return false;
+    }
+    prepareRun(state.startedAt);
+    runFingerprint = state.fingerprint;
+    watchProperties(false);
+    connectDetached();
+    Q_EMIT output("Reattached to " + getName() + "\n");
+    Q_EMIT started();
+    return true;
+}
+
+void TaskRunner::connectDetached()
+{
+    connect(detached, &DetachedRun::output, this, &TaskRunner::processOutput);
+    connect(detached, &DetachedRun::finished, [=](int exitCode) {
+        detached->deleteLater();
+        detached = nullptr;
+        runFinished(exitCode);
+    });
+}
+
+void TaskRunner::failedToStart()
+{
+    releaseWorkDir();
+    Q_EMIT output(QString("Unable to start SBY\n"));
+    stopWatching();
+    item->update();
+    Q_EMIT finished(-1);
+}
+
+void TaskRunner::runFinished(int exitCode)
+{
+    releaseWorkDir();
+    stopWatching();
+    progressTimer->stop();
+    if (!killStatus.isEmpty()) {
+        item->writeStatusXML(killStatus, killMessage, elapsedSeconds());
+        Q_EMIT output("---TASK KILLED: " + killMessage + "---\n");
+    } else {
+        item->storeFingerprint(runFingerprint);
+    }
+    item->update();
+    if (killStatus.isEmpty() && (item->getStatus() == "PASS" || item->getStatus() == "FAIL"))
+        ResultCache::instance().storeLater(runFingerprint, item->getWorkDir());
+    if (exitCode != 0)
+        Q_EMIT output(QString("---TASK STOPPED---\n"));
+    Q_EMIT finished(exitCode);
+}
+void TaskRunner::processOutput(QString data)
+{
+    Q_EMIT output(data);
+    bool changed = false;
+    for (auto &event : parser.feed(data)) {
+        changed |= item->getRunProgress().apply(event);
+        if (event.type != SBYEvent::Step)
+            Q_EMIT sbyEvent(event);
+    }
+    if (changed && !progressTimer->isActive())
+        progressTimer->start();
+}
+
+void TaskRunner::pollStatus()
+{
+    if (statusPoller)
+        statusPoller->poll();
+}
+
+void TaskRunner::stop()
+{
+    stopRequested = true;
+    if (process)
+        process->terminateTree();
+    if (detached)
+        detached->terminateTree();
+    if (remote)
+        remote->stop();
+}
+
+void TaskRunner::kill(QString status, QString message)
+{
+    if (!isRunning() || !killStatus.isEmpty())
+        return;
+    killStatus = status;
+    killMessage = message;
+    if (process)
+        process->killTree();
+    else if (detached)
+        detached->killTree();
+    else
+        remote->stop();
+}
@@ -0,0 +1,104 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TASKRUNNER_H
+#define TASKRUNNER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QProcessEnvironment>
+#include <QTimer>
+#include "detachedrun.h"
+#include "outputparser.h"
+#include "sbyitem.h"
+#include "sbyprocess.h"
+#include "statusrefresher.h"
+#include "workerpool.h"
+
+// Runs sby for a single task or file, locally or on a worker, and leaves
+// the result, fingerprint and cache entry behind. Has no widgets so the
+// batch mode can use it as well. Given a run directory, local runs are
+// started detached and keep going when the runner is released.
+class TaskRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit TaskRunner(SBYItem *item, QObject *parent = 0);
+    virtual ~TaskRunner();
+
+    void setRunDirectory(QString dir) { runDirectory = dir; }
+    void start(QProcessEnvironment env, WorkerPool *pool = nullptr);
+    // picks up a detached run of an earlier GUI, false if it is gone
+    bool attach(const DetachedState &state);
+    void stop();
+    void kill(QString status, QString message);
+    // leaves a detached run going when the runner is deleted
+    void release() { released = true; }
+    bool isRunning() { return process || remote || detached; }
+    bool isDetached() { return detached != nullptr; }
+    DetachedState detachedState();
+    qint64 processId();
+    QString getName();
+
+  Q_SIGNALS:
+    void started();
+    void output(QString data);
+    void finished(int exitCode);
+    // properties, steps or engines of the run changed state
+    void progress();
+    // everything but steps, those only show up through progress
+    void sbyEvent(SBYEvent event);
+
+  protected:
+    QString logFile();
+    void claimWorkDir();
+    void releaseWorkDir();
+    void launch(QProcessEnvironment env, WorkerPool *pool);
+    void prepareRun(qint64 started);
+    void watchProperties(bool fresh);
+    void stopWatching();
+    void failedToStart();
+    void connectDetached();
+    void runFinished(int exitCode);
+    int elapsedSeconds();
+    void pollStatus();
+    void processOutput(QString data);
+
+    SBYItem *item;
+    SBYProcess *process;
+    RemoteRun *remote;
+    DetachedRun *detached;
+    QString runDirectory;
+    bool released;
+    // waiting for the result cache, a stop just keeps sby from starting
+    QMetaObject::Connection restoring;
+    bool stopRequested;
+    QString killStatus;
+    QString killMessage;
+    qint64 runStartedAt;
+    QString runFingerprint;
+    QString claimedDir;
+    QTimer *pollTimer;
+    QTimer *progressTimer;
+    OutputParser parser;
+    StatusPoller *statusPoller;
+};
+
+#endif // TASKRUNNER_H
@@ -0,0 +1,81 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "watchqueue.h"
+#include <QFileInfo>
+
+// quiet time before a batch goes out, and the longest a batch is held back
+// while events keep coming in
+static const int settleTime = 200;
+static const int maxDelay = 2000;
+
+WatchQueue::WatchQueue(QObject *parent) : QObject(parent)
+{
+    watcher = new QFileSystemWatcher(this);
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &WatchQueue::flush);
+    connect(watcher, &QFileSystemWatcher::fileChanged, [=](const QString &path) { queue(files, path); });
+    connect(watcher, &QFileSystemWatcher::directoryChanged, [=](const QString &path) { queue(directories, path); });
+}
+
+void WatchQueue::addPath(QString path)
+{
+    if (!isWatched(path))
+        watcher->addPath(path);
+}
+
+void WatchQueue::removePath(QString path)
+{
+    if (isWatched(path))
+        watcher->removePath(path);
+}
+
+void WatchQueue::clear()
+{
+    if (!watcher->files().isEmpty())
+        watcher->removePaths(watcher->files());
+    if (!watcher->directories().isEmpty())
+        watcher->removePaths(watcher->directories());
+    files.clear();
+    directories.clear();
+    timer->stop();
+}
+
+void WatchQueue::queue(QSet<QString> &set, QString path)
+{
+    if (files.isEmpty() && directories.isEmpty())
+        firstEvent.start();
+    set.insert(path);
+    timer->start(qMax(0, qMin(settleTime, maxDelay - int(firstEvent.elapsed()))));
+}
+
+void WatchQueue::flush()
+{
+    // saving through rename or delete and re-create makes the watcher drop
+    // the path, pick it up again once the new file is there
+    for (auto path : files)
+        if (QFileInfo(path).isFile())
+            addPath(path);
+    QStringList changedFiles = files.toList();
+    QStringList changedDirectories = directories.toList();
+    files.clear();
+    directories.clear();
+    Q_EMIT changed(changedFiles, changedDirectories);
+}
@@ -0,0 +1,60 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WATCHQUEUE_H
+#define WATCHQUEUE_H
+
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+// Collects file system watcher events until things have been quiet for a
+// moment and hands them over as one batch with every path only once. A
+// checkout or a code generator touching hundreds of files ends up as a
+// single update.
+class WatchQueue : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit WatchQueue(QObject *parent = 0);
+
+    void addPath(QString path);
+    void removePath(QString path);
+    bool isWatched(QString path) { return watcher->files().contains(path) || watcher->directories().contains(path); }
+    void clear();
+
+  Q_SIGNALS:
+    void changed(QStringList files, QStringList directories);
+
+  protected:
+    void queue(QSet<QString> &set, QString path);
+    void flush();
+
+    QFileSystemWatcher *watcher;
+    QTimer *timer;
+    QElapsedTimer firstEvent;
+    QSet<QString> files;
+    QSet<QString> directories;
+};
+
+#endif // WATCHQUEUE_H
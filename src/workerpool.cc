@@ -0,0 +1,211 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "workerpool.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <algorithm>
+#include "fingerprint.h"
+#include "workerprotocol.h"
+
+RemoteRun::RemoteRun(WorkerPool *pool, int id, QString worker, QString workdir)
+        : QObject(pool), pool(pool), id(id), worker(worker), workdir(workdir)
+{
+}
+
+void RemoteRun::stop() { pool->stop(id); }
+
+WorkerPool::WorkerPool(QObject *parent) : QObject(parent), secret(WorkerProtocol::secret()), nextId(1) {}
+
+WorkerPool::~WorkerPool() { qDeleteAll(workers); }
+
+bool WorkerPool::addWorker(QString address)
+{
+    Worker *worker = new Worker{address, QString(), 0, address, 0, QString(), nullptr, nullptr, {}};
+    if (!WorkerProtocol::parseAddress(address, worker->host, worker->port)) {
+        delete worker;
+        return false;
+    }
+    if (worker->host.isEmpty())
+        worker->host = "localhost";
+    workers << worker;
+
+    worker->socket = new QTcpSocket(this);
+    worker->retry = new QTimer(this);
+    worker->retry->setSingleShot(true);
+    worker->retry->setInterval(5000);
+    connect(worker->retry, &QTimer::timeout, [=]() { worker->socket->connectToHost(worker->host, worker->port); });
+    connect(worker->socket, &QTcpSocket::readyRead, [=]() {
+        for (auto message : WorkerProtocol::receive(worker->socket))
+            handleMessage(worker, message);
+    });
+    connect(worker->socket, &QTcpSocket::disconnected, [=]() { connectionLost(worker); });
+    connect(worker->socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error),
+            [=](QAbstractSocket::SocketError) {
+                if (worker->socket->state() == QAbstractSocket::UnconnectedState)
+                    connectionLost(worker);
+            });
+    worker->socket->connectToHost(worker->host, worker->port);
+    return true;
+}
+
+int WorkerPool::getSlots()
+{
+    int slots = 0;
+    for (auto worker : workers)
+        slots += worker->slots;
+    return slots;
+}
+
+int WorkerPool::getFreeSlots()
+{
+    int slots = 0;
+    for (auto worker : workers)
+        slots += std::max(worker->slots - worker->runs.size(), 0);
+    return slots;
+}
+
+QString WorkerPool::getStatus()
+{
+    QStringList status;
+    for (auto worker : workers) {
+        if (worker->slots)
+            status << QString("%1 %2/%3").arg(worker->name).arg(worker->runs.size()).arg(worker->slots);
+        else if (!worker->error.isEmpty())
+            status << worker->address + " " + worker->error;
+        else
+            status << worker->address + " offline";
+    }
+    return status.join(", ");
+}
+
+void WorkerPool::connectionLost(Worker *worker)
+{
+    auto runs = worker->runs;
+    worker->runs.clear();
+    worker->slots = 0;
+    for (auto run : runs)
+        if (run)
+            Q_EMIT run->finished(-1, "lost connection to worker " + worker->name);
+    if (!worker->retry->isActive())
+        worker->retry->start();
+    Q_EMIT changed();
+}
+
+void WorkerPool::handleMessage(Worker *worker, const QJsonObject &message)
+{
+    QString type = message["type"].toString();
+    int id = message["id"].toInt();
+    if (type == "hello") {
+        QJsonObject auth;
+        auth["type"] = "auth";
+        auth["mac"] = WorkerProtocol::authenticate(secret, message["nonce"].toString());
+        WorkerProtocol::send(worker->socket, auth);
+    } else if (type == "ready") {
+        worker->name = message["host"].toString() + ":" + QString::number(worker->port);
+        worker->slots = message["slots"].toInt();
+        worker->error.clear();
+        Q_EMIT changed();
+    } else if (type == "error") {
+        worker->error = message["message"].toString();
+        Q_EMIT changed();
+    } else if (type == "log") {
+        RemoteRun *run = worker->runs.value(id);
+        if (run)
+            Q_EMIT run->output(message["data"].toString());
+    } else if (type == "result") {
+        RemoteRun *run = worker->runs.take(id);
+        if (run) {
+            // same layout a local sby -f run leaves behind
+            QDir(run->getWorkDir()).removeRecursively();
+            QDir().mkpath(run->getWorkDir());
+            QString error = message["error"].toString();
+            if (!WorkerProtocol::unpackFiles(message["files"].toObject(), run->getWorkDir()) && error.isEmpty())
+                error = "invalid result received from worker " + worker->name;
+            Q_EMIT run->finished(message["exitCode"].toInt(), error);
+        }
+        Q_EMIT changed();
+    }
+}
+
+QString WorkerPool::stageConfig(SBYItem *item, QJsonObject &files)
+{
+    // sources are shipped under sources/, keeping the names sby copies them to
+    QDir base(item->getWorkFolder());
+    QStringList lines;
+    bool inFiles = false;
+    int entries = 0;
+    for (auto line : item->getContents().split('\n')) {
+        QString trimmed = line.trimmed();
+        if (trimmed.startsWith('[')) {
+            inFiles = trimmed == "[files]";
+        } else if (inFiles && !trimmed.isEmpty() && !trimmed.startsWith('#')) {
+            QStringList parts = trimmed.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+            QString source = Fingerprint::sourcePath(trimmed, base);
+            QString dest = parts.size() > 1 ? parts.first() : QFileInfo(parts.last()).fileName();
+            QString staged = QString("sources/%1_%2").arg(entries++).arg(QFileInfo(source).fileName());
+            // directories go along with everything below them
+            WorkerProtocol::packPath(source, staged, files);
+            line = dest + " " + staged;
+        }
+        lines << line;
+    }
+    return lines.join('\n');
+}
+
+RemoteRun *WorkerPool::start(SBYItem *item)
+{
+    Worker *best = nullptr;
+    for (auto worker : workers)
+        if (worker->slots > worker->runs.size() &&
+            (!best || worker->slots - worker->runs.size() > best->slots - best->runs.size()))
+            best = worker;
+    if (!best)
+        return nullptr;
+
+    int id = nextId++;
+    QJsonObject files;
+    QJsonObject spec;
+    spec["type"] = "run";
+    spec["id"] = id;
+    spec["name"] = item->isTop() ? item->getRelativeName() : item->getRelativeName() + "#" + item->getTaskName();
+    spec["dir"] = QDir(item->getWorkDir()).dirName();
+    spec["config"] = stageConfig(item, files);
+    spec["files"] = files;
+    WorkerProtocol::send(best->socket, spec);
+
+    RemoteRun *run = new RemoteRun(this, id, best->name, item->getWorkDir());
+    best->runs[id] = run;
+    Q_EMIT changed();
+    return run;
+}
+
+void WorkerPool::stop(int id)
+{
+    for (auto worker : workers) {
+        if (worker->runs.contains(id)) {
+            QJsonObject message;
+            message["type"] = "stop";
+            message["id"] = id;
+            WorkerProtocol::send(worker->socket, message);
+        }
+    }
+}
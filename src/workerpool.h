@@ -0,0 +1,103 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+#include "sbyitem.h"
+
+class WorkerPool;
+
+// A task running on a worker daemon, results are unpacked into the
+// local workdir before finished() is emitted.
+class RemoteRun : public QObject
+{
+    Q_OBJECT
+
+  public:
+    RemoteRun(WorkerPool *pool, int id, QString worker, QString workdir);
+
+    void stop();
+    QString getWorker() { return worker; }
+    QString getWorkDir() { return workdir; }
+
+  Q_SIGNALS:
+    void output(QString data);
+    void finished(int exitCode, QString error);
+
+  protected:
+    WorkerPool *pool;
+    int id;
+    QString worker;
+    QString workdir;
+};
+
+// Connections to the sby-gui --worker daemons given as host:port,
+// reconnecting when a worker goes away. The secret shared with them is
+// taken from the environment, see WorkerProtocol.
+class WorkerPool : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit WorkerPool(QObject *parent = 0);
+    virtual ~WorkerPool();
+
+    bool addWorker(QString address);
+    bool isEmpty() { return workers.isEmpty(); }
+    int getSlots();
+    int getFreeSlots();
+    QString getStatus();
+    RemoteRun *start(SBYItem *item);
+    void stop(int id);
+
+  Q_SIGNALS:
+    void changed();
+
+  protected:
+    struct Worker
+    {
+        QString address;
+        QString host;
+        quint16 port;
+        QString name;
+        int slots;
+        QString error;
+        QTcpSocket *socket;
+        QTimer *retry;
+        QMap<int, QPointer<RemoteRun>> runs;
+    };
+
+    void handleMessage(Worker *worker, const QJsonObject &message);
+    void connectionLost(Worker *worker);
+    QString stageConfig(SBYItem *item, QJsonObject &files);
+
+    QList<Worker *> workers;
+    QByteArray secret;
+    int nextId;
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,126 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "workerprotocol.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMessageAuthenticationCode>
+
+bool WorkerProtocol::parseAddress(QString address, QString &host, quint16 &port)
+{
+    // "host:port", "host" or just "port"
+    bool ok = true;
+    int colon = address.lastIndexOf(':');
+    if (colon >= 0) {
+        host = address.left(colon);
+        port = address.mid(colon + 1).toUShort(&ok);
+    } else {
+        port = address.toUShort(&ok);
+        if (ok) {
+            host.clear();
+        } else {
+            host = address;
+            port = defaultPort();
+            ok = true;
+        }
+    }
+    return ok && port != 0;
+}
+
+QByteArray WorkerProtocol::secret() { return qgetenv(secretVariable()); }
+
+QString WorkerProtocol::authenticate(QByteArray secret, QString nonce)
+{
+    return QString::fromLatin1(
+            QMessageAuthenticationCode::hash(nonce.toLatin1(), secret, QCryptographicHash::Sha256).toHex());
+}
+
+void WorkerProtocol::send(QIODevice *device, const QJsonObject &message)
+{
+    device->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + "\n");
+}
+
+QList<QJsonObject> WorkerProtocol::receive(QIODevice *device)
+{
+    QList<QJsonObject> messages;
+    while (device->canReadLine()) {
+        QJsonDocument doc = QJsonDocument::fromJson(device->readLine());
+        if (doc.isObject())
+            messages << doc.object();
+    }
+    return messages;
+}
+
+QJsonObject WorkerProtocol::packFiles(QString dir, QStringList files)
+{
+    QJsonObject packed;
+    QDir base(dir);
+    for (auto name : files) {
+        QFile f(base.filePath(name));
+        if (f.open(QIODevice::ReadOnly))
+            packed[name] = QString::fromLatin1(f.readAll().toBase64());
+    }
+    return packed;
+}
+
+void WorkerProtocol::packPath(QString path, QString name, QJsonObject &files)
+{
+    QFileInfo info(path);
+    if (!info.isDir()) {
+        QJsonObject packed = packFiles(info.path(), QStringList() << info.fileName());
+        if (packed.contains(info.fileName()))
+            files[name] = packed[info.fileName()];
+        return;
+    }
+    QDir base(path);
+    QDirIterator it(path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString relative = base.relativeFilePath(it.next());
+        files[name + "/" + relative] = packFiles(path, QStringList() << relative).value(relative);
+    }
+}
+
+bool WorkerProtocol::isSafePath(QString path)
+{
+    if (path.isEmpty() || QDir::isAbsolutePath(path))
+        return false;
+    for (auto part : path.split('/'))
+        if (part.isEmpty() || part == "." || part == "..")
+            return false;
+    return true;
+}
+
+bool WorkerProtocol::unpackFiles(const QJsonObject &files, QString dir)
+{
+    QDir base(dir);
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        // never let the other side write outside of dir
+        if (!isSafePath(it.key()))
+            return false;
+        base.mkpath(QFileInfo(it.key()).path());
+        QFile f(base.filePath(it.key()));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        f.write(QByteArray::fromBase64(it.value().toString().toLatin1()));
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WORKERPROTOCOL_H
+#define WORKERPROTOCOL_H
+
+#include <QIODevice>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Messages between the GUI and sby-gui --worker daemons, one compact JSON
+// object per line. File contents travel base64 encoded. A worker runs
+// whatever sby config it gets, so each connection starts with proof of the
+// shared secret: an HMAC-SHA256 of the nonce sent by the worker.
+//
+//   worker -> gui  {"type":"hello","nonce":...}
+//   gui -> worker  {"type":"auth","mac":...}
+//   worker -> gui  {"type":"ready","host":...,"slots":N}
+//   worker -> gui  {"type":"error","message":...}
+//   gui -> worker  {"type":"run","id":N,"name":...,"dir":...,"config":...,"files":{path:data}}
+//   gui -> worker  {"type":"stop","id":N}
+//   worker -> gui  {"type":"log","id":N,"data":...}
+//   worker -> gui  {"type":"result","id":N,"exitCode":N,"files":{path:data}}
+class WorkerProtocol
+{
+  public:
+    static quint16 defaultPort() { return 7719; }
+    static const char *secretVariable() { return "SBYGUI_WORKER_SECRET"; }
+    static QByteArray secret();
+    static QString authenticate(QByteArray secret, QString nonce);
+    static bool parseAddress(QString address, QString &host, quint16 &port);
+
+    static void send(QIODevice *device, const QJsonObject &message);
+    static QList<QJsonObject> receive(QIODevice *device);
+
+    static QJsonObject packFiles(QString dir, QStringList files);
+    // a file, or everything below a directory, under the given name
+    static void packPath(QString path, QString name, QJsonObject &files);
+    static bool unpackFiles(const QJsonObject &files, QString dir);
+    static bool isSafePath(QString path);
+};
+
+#endif // WORKERPROTOCOL_H
@@ -0,0 +1,265 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "workerserver.h"
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QSysInfo>
+#include <QTextCodec>
+#include <QTextStream>
+#include "resultcache.h"
+#include "workerprotocol.h"
+
+WorkerServer::WorkerServer(int slots, QByteArray secret, QObject *parent) : QObject(parent), slots(slots), secret(secret)
+{
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &WorkerServer::newConnection);
+}
+
+WorkerServer::~WorkerServer()
+{
+    for (auto run : running) {
+        run->process->disconnect();
+        run->process->terminateTree();
+        run->process->waitForFinished(1000);
+        delete run->process;
+        delete run->decoder;
+        delete run->stage;
+        delete run;
+    }
+    qDeleteAll(pending);
+}
+
+bool WorkerServer::listen(QString address)
+{
+    QString host;
+    quint16 port;
+    if (!WorkerProtocol::parseAddress(address, host, port)) {
+        error = "invalid address";
+        return false;
+    }
+    QHostAddress bind = host.isEmpty() || host == "localhost" ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(host);
+    if (bind.isNull()) {
+        error = "invalid address";
+        return false;
+    }
+    // whoever gets in can run anything through sby
+    if (!bind.isLoopback() && secret.isEmpty()) {
+        error = QString("listening beyond the loopback interface needs a secret in %1")
+                        .arg(WorkerProtocol::secretVariable());
+        return false;
+    }
+    error.clear();
+    return server->listen(bind, port);
+}
+
+void WorkerServer::newConnection()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        QTextStream(stdout) << "Connection from " << socket->peerAddress().toString() << endl;
+        connect(socket, &QTcpSocket::readyRead, [=]() { readMessages(socket); });
+        connect(socket, &QTcpSocket::disconnected, [=]() { disconnected(socket); });
+        QString nonce = QString::number(QRandomGenerator::system()->generate64(), 16) +
+                        QString::number(QRandomGenerator::system()->generate64(), 16);
+        unauthenticated[socket] = nonce;
+        QJsonObject hello;
+        hello["type"] = "hello";
+        hello["nonce"] = nonce;
+        WorkerProtocol::send(socket, hello);
+    }
+}
+
+static bool sameMac(const QByteArray &a, const QByteArray &b)
+{
+    // without an early exit, so the time taken tells nothing
+    if (a.size() != b.size())
+        return false;
+    char diff = 0;
+    for (int i = 0; i < a.size(); i++)
+        diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+void WorkerServer::readMessages(QTcpSocket *socket)
+{
+    if (unauthenticated.contains(socket)) {
+        // strangers do not get to fill up memory with a line that never ends
+        if (!socket->canReadLine() && socket->bytesAvailable() > 4096) {
+            socket->abort();
+            return;
+        }
+        if (!socket->canReadLine())
+            return;
+        QJsonObject auth = QJsonDocument::fromJson(socket->readLine()).object();
+        QString expected = WorkerProtocol::authenticate(secret, unauthenticated.value(socket));
+        if (auth["type"].toString() != "auth" || !sameMac(auth["mac"].toString().toLatin1(), expected.toLatin1())) {
+            QTextStream(stdout) << "Authentication failed for " << socket->peerAddress().toString() << endl;
+            QJsonObject refused;
+            refused["type"] = "error";
+            refused["message"] = "authentication failed";
+            WorkerProtocol::send(socket, refused);
+            socket->disconnectFromHost();
+            return;
+        }
+        unauthenticated.remove(socket);
+        QJsonObject ready;
+        ready["type"] = "ready";
+        ready["host"] = QSysInfo::machineHostName();
+        ready["slots"] = slots;
+        WorkerProtocol::send(socket, ready);
+    }
+    for (auto message : WorkerProtocol::receive(socket))
+        handleMessage(socket, message);
+}
+
+void WorkerServer::disconnected(QTcpSocket *socket)
+{
+    unauthenticated.remove(socket);
+    // nobody is left to receive the results
+    for (int i = pending.size() - 1; i >= 0; i--) {
+        if (pending[i]->socket == socket)
+            delete pending.takeAt(i);
+    }
+    for (auto run : running) {
+        if (run->socket == socket) {
+            run->socket = nullptr;
+            run->process->terminateTree();
+        }
+    }
+    socket->deleteLater();
+}
+
+void WorkerServer::handleMessage(QTcpSocket *socket, const QJsonObject &message)
+{
+    QString type = message["type"].toString();
+    int id = message["id"].toInt();
+    if (type == "run") {
+        Run *run = new Run{socket, id, message, nullptr, nullptr, nullptr};
+        pending << run;
+        schedule();
+    } else if (type == "stop") {
+        for (auto run : pending) {
+            if (run->socket == socket && run->id == id) {
+                pending.removeAll(run);
+                sendError(run, "stopped before start");
+                delete run;
+                return;
+            }
+        }
+        for (auto run : running)
+            if (run->socket == socket && run->id == id)
+                run->process->terminateTree();
+    }
+}
+
+void WorkerServer::schedule()
+{
+    while (!pending.isEmpty() && running.size() < slots) {
+        Run *run = pending.takeFirst();
+        startRun(run);
+    }
+}
+
+void WorkerServer::sendError(Run *run, QString message)
+{
+    if (!run->socket)
+        return;
+    QJsonObject result;
+    result["type"] = "result";
+    result["id"] = run->id;
+    result["exitCode"] = -1;
+    result["error"] = message;
+    WorkerProtocol::send(run->socket, result);
+}
+
+void WorkerServer::startRun(Run *run)
+{
+    QString dir = run->spec["dir"].toString();
+    run->stage = new QTemporaryDir();
+    if (!WorkerProtocol::isSafePath(dir) || dir.contains('/') || !run->stage->isValid() ||
+        !WorkerProtocol::unpackFiles(run->spec["files"].toObject(), run->stage->path())) {
+        sendError(run, "unable to stage task");
+        delete run->stage;
+        delete run;
+        return;
+    }
+    // named after the local workdir, so sby creates the same layout here
+    QFile config(run->stage->path() + "/" + dir + ".sby");
+    if (!config.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        sendError(run, "unable to stage task");
+        delete run->stage;
+        delete run;
+        return;
+    }
+    config.write(run->spec["config"].toString().toUtf8());
+    config.close();
+
+    QTextStream(stdout) << "Running " << run->spec["name"].toString() << endl;
+    running << run;
+    run->process = new SBYProcess;
+    run->decoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("PYTHONUNBUFFERED", "1");
+    run->process->setProcessEnvironment(env);
+    run->process->setWorkingDirectory(run->stage->path());
+    run->process->setProcessChannelMode(QProcess::MergedChannels);
+    run->process->setProgram("sby");
+    run->process->setArguments(QStringList() << "-f" << dir + ".sby");
+    connect(run->process, &QProcess::readyReadStandardOutput, [=]() {
+        QByteArray data = run->process->readAllStandardOutput();
+        if (!run->socket)
+            return;
+        QJsonObject log;
+        log["type"] = "log";
+        log["id"] = run->id;
+        log["data"] = run->decoder->toUnicode(data);
+        WorkerProtocol::send(run->socket, log);
+    });
+    connect(run->process, &QProcess::errorOccurred, [=](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            runFinished(run, -1);
+    });
+    connect(run->process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            [=](int exitCode, QProcess::ExitStatus) { runFinished(run, exitCode); });
+    run->process->start();
+}
+
+void WorkerServer::runFinished(Run *run, int exitCode)
+{
+    if (!running.removeAll(run))
+        return;
+    if (run->socket) {
+        QString workdir = run->stage->path() + "/" + run->spec["dir"].toString();
+        QJsonObject result;
+        result["type"] = "result";
+        result["id"] = run->id;
+        result["exitCode"] = exitCode;
+        result["files"] = WorkerProtocol::packFiles(workdir, ResultCache::resultFiles(workdir));
+        if (run->process->error() == QProcess::FailedToStart)
+            result["error"] = "unable to start sby on " + QSysInfo::machineHostName();
+        WorkerProtocol::send(run->socket, result);
+    }
+    QTextStream(stdout) << "Finished " << run->spec["name"].toString() << " (" << exitCode << ")" << endl;
+    run->process->deleteLater();
+    delete run->decoder;
+    delete run->stage;
+    delete run;
+    schedule();
+}
@@ -0,0 +1,78 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WORKERSERVER_H
+#define WORKERSERVER_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTextDecoder>
+#include "sbyprocess.h"
+
+// Daemon side of the worker protocol: runs sby for task specs received
+// over TCP in a staged directory and streams log and results back.
+class WorkerServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    WorkerServer(int slots, QByteArray secret, QObject *parent = 0);
+    virtual ~WorkerServer();
+
+    // without a secret only on the loopback interface
+    bool listen(QString address);
+    QString errorString() { return error.isEmpty() ? server->errorString() : error; }
+
+  protected:
+    struct Run
+    {
+        QTcpSocket *socket;
+        int id;
+        QJsonObject spec;
+        QTemporaryDir *stage;
+        SBYProcess *process;
+        // reads end anywhere, multi byte characters included
+        QTextDecoder *decoder;
+    };
+
+    void newConnection();
+    void disconnected(QTcpSocket *socket);
+    void readMessages(QTcpSocket *socket);
+    void handleMessage(QTcpSocket *socket, const QJsonObject &message);
+    void schedule();
+    void startRun(Run *run);
+    void runFinished(Run *run, int exitCode);
+    void sendError(Run *run, QString message);
+
+    QTcpServer *server;
+    int slots;
+    QByteArray secret;
+    QString error;
+    // nonce per connection until it proved to know the secret
+    QMap<QTcpSocket *, QString> unauthenticated;
+    QList<Run *> pending;
+    QList<Run *> running;
+};
+
+#endif // WORKERSERVER_H
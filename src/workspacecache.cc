@@ -0,0 +1,140 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "workspacecache.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include "fingerprint.h"
+
+static const int cacheVersion = 1;
+
+void WorkspaceCache::load(QDir folder)
+{
+    entries = QJsonObject();
+    QFile f(folder.filePath(fileName()));
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    if (root["version"].toInt() == cacheVersion)
+        entries = root["files"].toObject();
+}
+
+void WorkspaceCache::save(QDir folder, const std::vector<std::unique_ptr<SBYFile>> &files)
+{
+    entries = QJsonObject();
+    for (auto &file : files) {
+        if (file->getParsedHash().isEmpty())
+            continue;
+        QJsonObject entry;
+        entry["size"] = double(file->getParsedSize());
+        entry["mtime"] = double(file->getParsedModified());
+        entry["hash"] = QString(file->getParsedHash());
+        entry["tasks"] = QJsonArray::fromStringList(file->getTaskList());
+        QJsonObject configs;
+        QJsonObject sources;
+        QJsonObject status;
+        for (auto it = file->getConfigs().begin(); it != file->getConfigs().end(); ++it)
+            configs[it.key()] = it.value();
+        status[""] = statusOf(file.get());
+        if (file->haveTasks()) {
+            for (auto &task : file->getTasks()) {
+                sources[task->getTaskName()] = QJsonArray::fromStringList(task->getFiles());
+                status[task->getTaskName()] = statusOf(task.get());
+            }
+        } else {
+            sources[""] = QJsonArray::fromStringList(file->getFiles());
+        }
+        entry["configs"] = configs;
+        entry["files"] = sources;
+        entry["status"] = status;
+        entries[file->getRelativeName()] = entry;
+    }
+    QJsonObject root;
+    root["version"] = cacheVersion;
+    root["files"] = entries;
+    // never leave a half written cache behind
+    QSaveFile f(folder.filePath(fileName()));
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    f.commit();
+}
+
+QJsonObject WorkspaceCache::statusOf(SBYItem *item)
+{
+    QJsonObject status;
+    status["status"] = item->getStatus();
+    status["color"] = item->getStatusColor();
+    status["percentage"] = item->getPercentage();
+    status["time"] = item->getTimeSpent();
+    return status;
+}
+
+bool WorkspaceCache::isCurrent(const QJsonObject &entry, QFileInfo path)
+{
+    return !entry.isEmpty() && entry["size"].toDouble() == path.size() &&
+           entry["mtime"].toDouble() == path.lastModified().toMSecsSinceEpoch();
+}
+
+bool WorkspaceCache::restoreParsed(SBYFile *file, const QJsonObject &entry, bool checkHash)
+{
+    if (entry.isEmpty())
+        return false;
+    QFileInfo info(file->getFullPath());
+    QByteArray hash = entry["hash"].toString().toLatin1();
+    if (checkHash) {
+        // the stored mtime may be off after a checkout, the contents decide
+        QByteArray current = Fingerprint::fileHash(info.absoluteFilePath());
+        if (current != hash)
+            return false;
+        file->setParsedKey(info.size(), info.lastModified().toMSecsSinceEpoch(), hash);
+    } else {
+        file->setParsedKey(qint64(entry["size"].toDouble()), qint64(entry["mtime"].toDouble()), hash);
+    }
+    QStringList tasks;
+    for (auto task : entry["tasks"].toArray())
+        tasks << task.toString();
+    QMap<QString, QString> configs;
+    QJsonObject storedConfigs = entry["configs"].toObject();
+    for (auto it = storedConfigs.begin(); it != storedConfigs.end(); ++it)
+        configs[it.key()] = it.value().toString();
+    QMap<QString, QStringList> sources;
+    QJsonObject storedSources = entry["files"].toObject();
+    for (auto it = storedSources.begin(); it != storedSources.end(); ++it)
+        for (auto source : it.value().toArray())
+            sources[it.key()] << source.toString();
+    file->setParsed(tasks, configs, sources);
+    return true;
+}
+
+void WorkspaceCache::restoreStatus(SBYFile *file, const QJsonObject &entry)
+{
+    QJsonObject status = entry["status"].toObject();
+    auto restore = [&](SBYItem *item, QString key) {
+        QJsonObject state = status[key].toObject();
+        item->setState(state["status"].toString(), state["color"].toInt(), state["percentage"].toInt(),
+                       state.contains("time") ? state["time"].toInt() : -1);
+    };
+    restore(file, "");
+    for (auto &task : file->getTasks())
+        restore(task.get(), task->getTaskName());
+}
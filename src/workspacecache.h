@@ -0,0 +1,52 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WORKSPACECACHE_H
+#define WORKSPACECACHE_H
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <memory>
+#include <vector>
+#include "sbyitem.h"
+
+// Parsed .sby files of one folder together with the last known status of
+// their tasks, so a workspace shows up at once and only files that
+// changed get parsed again. Kept as JSON next to the .sby files.
+class WorkspaceCache
+{
+  public:
+    static QString fileName() { return ".sby-gui-cache"; }
+
+    void load(QDir folder);
+    void save(QDir folder, const std::vector<std::unique_ptr<SBYFile>> &files);
+    // by path relative to the folder
+    QJsonObject entry(QString name) { return entries.value(name).toObject(); }
+    static bool isCurrent(const QJsonObject &entry, QFileInfo path);
+    static bool restoreParsed(SBYFile *file, const QJsonObject &entry, bool checkHash);
+    static void restoreStatus(SBYFile *file, const QJsonObject &entry);
+
+  protected:
+    static QJsonObject statusOf(SBYItem *item);
+
+    QJsonObject entries;
+};
+
+#endif // WORKSPACECACHE_H
@@ -0,0 +1,3 @@
+module sub(input a, output b);
+    assign b = a;
+endmodule
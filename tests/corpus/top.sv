@@ -0,0 +1,8 @@
+module top(input clk, input [3:0] in, output reg [3:0] out);
+    always @(posedge clk)
+        out <= in;
+`ifdef FORMAL
+    always @(posedge clk)
+        assert (out == $past(in) || $initstate);
+`endif
+endmodule
@@ -0,0 +1,113 @@
+/*
+ *  sby-gui -- SymbiYosys GUI
+ *
+ *  Copyright (C) 2019  Miodrag Milanovic <miodrag@symbioticeda.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <gtest/gtest.h>
+#include "sbyconfig.h"
+
+static QString corpus(QString name) { return QDir(SBY_CORPUS_DIR).filePath(name); }
+
+TEST(SBYConfig, TaskGroups)
+{
+    SBYConfig config;
+    ASSERT_TRUE(config.read(corpus("groups.sby"))) << config.getReason().toStdString();
+    EXPECT_EQ(QStringList({"bmc_a", "bmc_b", "prove_a", "cover"}), config.getTasks());
+
+    QString bmcA = config.expand("bmc_a");
+    EXPECT_TRUE(bmcA.contains("\nmode bmc\n"));
+    EXPECT_TRUE(bmcA.contains("\nmulticlock on\n"));
+    EXPECT_FALSE(bmcA.contains("[tasks]"));
+    QString bmcB = config.expand("bmc_b");
+    EXPECT_TRUE(bmcB.contains("\nmode bmc\n"));
+    EXPECT_FALSE(bmcB.contains("multiclock"));
+    QString cover = config.expand("cover");
+    EXPECT_TRUE(cover.contains("\nmode cover\n"));
+    EXPECT_FALSE(cover.contains("mode bmc"));
+    EXPECT_TRUE(config.expand("nonexistent").isEmpty());
+}
+
+TEST(SBYConfig, TaskPrefixes)
+{
+    SBYConfig config;
+    ASSERT_TRUE(config.read(corpus("prefixes.sby"))) << config.getReason().toStdString();
+    EXPECT_EQ(QStringList({"fast", "full"}), config.getTasks());
+
+    QString fast = config.expand("fast");
+    EXPECT_TRUE(fast.contains("\ndepth 5\n"));
+    EXPECT_FALSE(fast.contains("depth 40"));
+    EXPECT_TRUE(fast.contains("\nsmtbmc yices\n"));
+    EXPECT_FALSE(fast.contains("boolector"));
+    EXPECT_TRUE(fast.contains("\nchparam -set SMALL 1 top\n"));
+    EXPECT_FALSE(fast.contains("--\n"));
+    QString full = config.expand("full");
+    EXPECT_TRUE(full.contains("\ndepth 40\n"));
+    EXPECT_TRUE(full.contains("\nsmtbmc boolector\nabc bmc3\n"));
+    EXPECT_FALSE(full.contains("yices"));
+    EXPECT_FALSE(full.contains("chparam"));
+}
+
+TEST(SBYConfig, DefaultTag)
+{
+    SBYConfig config;
+    ASSERT_TRUE(config.read(corpus("default.sby"))) << config.getReason().toStdString();
+    EXPECT_EQ(QStringList({"quick", "thorough"}), config.getTasks());
+    EXPECT_TRUE(config.expand("quick").contains("\ndepth 4\n"));
+    EXPECT_TRUE(config.expand("thorough").contains("\ndepth 30\n"));
+}
+
+TEST(SBYConfig, FilesWithoutTasks)
+{
+    SBYConfig config;
+    ASSERT_TRUE(config.read(corpus("files.sby"))) << config.getReason().toStdString();
+    EXPECT_TRUE(config.getTasks().isEmpty());
+    QFile f(corpus("files.sby"));
+    ASSERT_TRUE(f.open(QIODevice::ReadOnly));
+    EXPECT_EQ(QString::fromUtf8(f.readAll()), config.expand(QString()));
+}
+
+TEST(SBYConfig, Unsupported)
+{
+    SBYConfig pycode;
+    EXPECT_FALSE(pycode.read(corpus("pycode.sby")));
+    EXPECT_TRUE(pycode.getReason().contains("pycode"));
+    SBYConfig pattern;
+    EXPECT_FALSE(pattern.read(corpus("tag_pattern.sby")));
+    EXPECT_TRUE(pattern.getReason().contains("regular expression"));
+}
+
+// the same corpus through sby itself, only registered when sby is installed
+TEST(SBYConfigDumpcfg, Corpus)
+{
+    QTextStream out(stdout);
+    QFileInfoList files = QDir(SBY_CORPUS_DIR).entryInfoList(QStringList() << "*.sby", QDir::Files);
+    ASSERT_FALSE(files.isEmpty());
+    for (auto file : files)
+        EXPECT_TRUE(SBYConfig::compareWithSby(file, out)) << file.fileName().toStdString();
+}
+
+int main(int argc, char **argv)
+{
+    // sby is started through QProcess
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}